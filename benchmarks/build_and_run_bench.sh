@@ -6,6 +6,6 @@ set -o errexit -o nounset  # fail on error or on unset variables
 : "${CXX_COMPILER:=g++}"
 : "${CXX_FLAGS:=-std=c++11}"
 
-"$CXX_COMPILER" ${CXX_FLAGS} -O2 -Wall -pedantic -I.. enaml_like_benchmark.cpp -o run_bench
+"$CXX_COMPILER" ${CXX_FLAGS} -O2 -Wall -pedantic -pthread -I.. enaml_like_benchmark.cpp -o run_bench
 
 ./run_bench
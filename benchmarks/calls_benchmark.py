@@ -0,0 +1,90 @@
+# --------------------------------------------------------------------------------------
+# Copyright (c) 2026, Nucleic Development Team.
+#
+# Distributed under the terms of the Modified BSD License.
+#
+# The full license is in the file LICENSE, distributed with this software.
+# --------------------------------------------------------------------------------------
+"""Time the calls of the hot Solver and Variable methods from Python.
+
+Each benchmark makes the same call in a loop on a small system, so that
+the time is dominated by the cost of the call and of parsing its
+arguments rather than by the solver.
+
+"""
+
+import pyperf
+
+from kiwisolver import Solver, Variable
+
+CALLS = 100
+
+
+def make_solver():
+    """Make a solver with two edit variables and a few constraints."""
+    width = Variable("width")
+    height = Variable("height")
+    solver = Solver()
+    solver.addEditVariable(width, "strong")
+    solver.addEditVariable(height, "strong")
+    solver.addConstraint(width >= 10)
+    solver.addConstraint(height >= 0.5 * width)
+    return solver, width, height
+
+
+def bench_variable(loops):
+    t0 = pyperf.perf_counter()
+    for _ in range(loops):
+        for _ in range(CALLS):
+            Variable()
+    return pyperf.perf_counter() - t0
+
+
+def bench_named_variable(loops):
+    t0 = pyperf.perf_counter()
+    for _ in range(loops):
+        for _ in range(CALLS):
+            Variable("width")
+    return pyperf.perf_counter() - t0
+
+
+def bench_suggest_value(loops):
+    solver, width, _ = make_solver()
+    t0 = pyperf.perf_counter()
+    for _ in range(loops):
+        for _ in range(CALLS):
+            solver.suggestValue(width, 400)
+    return pyperf.perf_counter() - t0
+
+
+def bench_add_edit_variable(loops):
+    solver, _, _ = make_solver()
+    edit = Variable("edit")
+    t0 = pyperf.perf_counter()
+    for _ in range(loops):
+        for _ in range(CALLS):
+            solver.addEditVariable(edit, "weak")
+            solver.removeEditVariable(edit)
+    return pyperf.perf_counter() - t0
+
+
+def bench_values(loops):
+    solver, width, height = make_solver()
+    variables = [width, height]
+    t0 = pyperf.perf_counter()
+    for _ in range(loops):
+        for _ in range(CALLS):
+            solver.values(variables)
+    return pyperf.perf_counter() - t0
+
+
+if __name__ == "__main__":
+    runner = pyperf.Runner()
+    for name, func in [
+        ("Variable()", bench_variable),
+        ("Variable(name)", bench_named_variable),
+        ("Solver.suggestValue", bench_suggest_value),
+        ("Solver.addEditVariable + removeEditVariable", bench_add_edit_variable),
+        ("Solver.values", bench_values),
+    ]:
+        runner.bench_time_func(name, func, inner_loops=CALLS)
@@ -8,12 +8,21 @@
 
 // Time updating an EditVariable in a set of constraints typical of enaml use.
 
+#include <cstdio>
+#include <vector>
 #include <kiwi/kiwi.h>
 #define ANKERL_NANOBENCH_IMPLEMENT
 #include "nanobench.h"
 
 using namespace kiwi;
 
+void report_stats(const char* label, const Solver& solver)
+{
+    SolverStats stats = solver.stats();
+    std::printf("%-36s rows %4zu  cells %5zu  columns %4zu  density %.4f  pivots %zu\n",
+                label, stats.rows, stats.cells, stats.columns, stats.density(), stats.pivots);
+}
+
 void build_solver(Solver& solver, Variable& width, Variable& height)
 {
     // Create custom strength
@@ -182,6 +191,22 @@ void build_solver(Solver& solver, Variable& width, Variable& height)
 
 int main()
 {
+#if defined(KIWI_ATOMIC_REFCOUNT)
+    std::printf("reference counts: atomic\n");
+#else
+    std::printf("reference counts: plain\n");
+#endif
+
+    // Building expressions copies variables, which is dominated by the
+    // reference counts.
+    std::vector<Variable> variables(100);
+    ankerl::nanobench::Bench().run("building expressions", [&] {
+        Expression expr;
+        for (const Variable& variable : variables)
+            expr = expr + 2.0 * variable;
+        ankerl::nanobench::doNotOptimizeAway(expr);
+    });
+
     ankerl::nanobench::Bench().run("building solver", [&] {
         Solver solver;
         Variable width("width");
@@ -221,4 +246,34 @@ int main()
             solver.updateVariables();
         });
     }
+
+    ankerl::nanobench::Bench().run("building solver (minimize fill-in)", [&] {
+        Solver solver;
+        solver.setMinimizeFillIn(true);
+        Variable width("width");
+        Variable height("height");
+        build_solver(solver, width, height);
+        ankerl::nanobench::doNotOptimizeAway(solver);
+    });
+
+    // Report the tableau density right after building the solver and
+    // after cycling through the sizes, with and without the fill-in
+    // heuristic.
+    std::printf("\n");
+    for (bool fill_in : { false, true })
+    {
+        Solver solver;
+        solver.setMinimizeFillIn(fill_in);
+        Variable width("width");
+        Variable height("height");
+        build_solver(solver, width, height);
+        report_stats(fill_in ? "built (minimize fill-in)" : "built", solver);
+        for (int i = 0; i < 100; ++i)
+        {
+            const Size& size = sizes[i % (sizeof(sizes) / sizeof(Size))];
+            solver.suggestValue(width, size.width);
+            solver.suggestValue(height, size.height);
+        }
+        report_stats(fill_in ? "after resizes (minimize fill-in)" : "after resizes", solver);
+    }
 }
@@ -0,0 +1,73 @@
+# --------------------------------------------------------------------------------------
+# Copyright (c) 2013-2026, Nucleic Development Team.
+#
+# Distributed under the terms of the Modified BSD License.
+#
+# The full license is in the file LICENSE, distributed with this software.
+# --------------------------------------------------------------------------------------
+"""Time the construction of constraints with the symbolic operators.
+
+Each constraint of a grid layout goes through short-lived Term and
+Expression objects. Besides the duration, this reports the collections
+run by the cyclic garbage collector, the time spent in them, and the
+memory blocks kept alive per constraint.
+
+"""
+
+import gc
+import sys
+import time
+
+from kiwisolver import Variable
+
+ROWS = 100
+COLUMNS = 100
+REPEATS = 5
+
+
+def build(lefts, widths):
+    """Build the constraints of a grid of cells."""
+    constraints = []
+    for row in range(ROWS):
+        for col in range(1, COLUMNS):
+            i = row * COLUMNS + col
+            constraints.append(lefts[i] >= lefts[i - 1] + 2 * widths[i - 1] + 5)
+            constraints.append((widths[i] == 0.5 * widths[i - 1] + 10) | "weak")
+    return constraints
+
+
+def main():
+    lefts = [Variable(f"left{i}") for i in range(ROWS * COLUMNS)]
+    widths = [Variable(f"width{i}") for i in range(ROWS * COLUMNS)]
+    pauses = []
+
+    def track(phase, info):
+        if phase == "start":
+            pauses.append(time.perf_counter())
+        else:
+            pauses[-1] = time.perf_counter() - pauses[-1]
+
+    gc.callbacks.append(track)
+    best = None
+    for _ in range(REPEATS):
+        gc.collect()
+        del pauses[:]
+        blocks = sys.getallocatedblocks()
+        start = time.perf_counter()
+        constraints = build(lefts, widths)
+        duration = time.perf_counter() - start
+        allocated = sys.getallocatedblocks() - blocks
+        result = (duration, len(pauses), sum(pauses), allocated / len(constraints))
+        if best is None or result[0] < best[0]:
+            best = result
+        del constraints
+    gc.callbacks.remove(track)
+    duration, collections, pause, blocks = best
+    print(f"constraints: {2 * ROWS * (COLUMNS - 1)}")
+    print(f"duration: {duration * 1e3:.1f} ms")
+    print(f"collections: {collections}, pause: {pause * 1e3:.1f} ms")
+    print(f"blocks kept per constraint: {blocks:.1f}")
+
+
+if __name__ == "__main__":
+    main()
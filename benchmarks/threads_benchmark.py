@@ -0,0 +1,77 @@
+# --------------------------------------------------------------------------------------
+# Copyright (c) 2013-2026, Nucleic Development Team.
+#
+# Distributed under the terms of the Modified BSD License.
+#
+# The full license is in the file LICENSE, distributed with this software.
+# --------------------------------------------------------------------------------------
+"""Time independent solvers driven by several threads at once.
+
+Each thread builds its own solver, a chain of boxes laid out in a row, and
+resizes it repeatedly. On a free-threaded build the threads do not share
+any lock, so the throughput should grow with the number of threads.
+
+"""
+
+import sys
+import threading
+import time
+
+from kiwisolver import Solver, Variable
+
+BOXES = 50
+RESIZES = 200
+
+
+def layout_document():
+    """Build a solver for a row of boxes and resize it."""
+    solver = Solver()
+    width = Variable("width")
+    lefts = [Variable(f"left{i}") for i in range(BOXES)]
+    widths = [Variable(f"width{i}") for i in range(BOXES)]
+    solver.addEditVariable(width, "strong")
+    solver.addConstraint(lefts[0] == 0)
+    for i in range(BOXES):
+        solver.addConstraint(widths[i] >= 10)
+        solver.addConstraint((widths[i] == 50) | "weak")
+        if i + 1 < BOXES:
+            solver.addConstraint(lefts[i + 1] == lefts[i] + widths[i] + 5)
+    solver.addConstraint(lefts[-1] + widths[-1] <= width)
+    for i in range(RESIZES):
+        solver.suggestValue(width, 1000 + 10 * (i % 100))
+        solver.updateVariables()
+
+
+def run(threads, documents):
+    """Lay out the documents split across the threads, return the duration."""
+    per_thread = documents // threads
+
+    def work():
+        for _ in range(per_thread):
+            layout_document()
+
+    workers = [threading.Thread(target=work) for _ in range(threads)]
+    start = time.perf_counter()
+    for worker in workers:
+        worker.start()
+    for worker in workers:
+        worker.join()
+    return time.perf_counter() - start
+
+
+def main():
+    max_threads = int(sys.argv[1]) if len(sys.argv) > 1 else 8
+    documents = 8 * max_threads
+    gil = getattr(sys, "_is_gil_enabled", lambda: True)()
+    print(f"GIL enabled: {gil}, documents: {documents}")
+    baseline = run(1, documents)
+    print(f"threads  1: {baseline:.3f} s")
+    threads = 2
+    while threads <= max_threads:
+        duration = run(threads, documents)
+        print(f"threads {threads:2d}: {duration:.3f} s  speedup {baseline / duration:.2f}")
+        threads *= 2
+
+
+if __name__ == "__main__":
+    main()
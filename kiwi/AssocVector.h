@@ -169,6 +169,8 @@ namespace Loki
         bool empty() const { return Base::empty(); }
         size_type size() const { return Base::size(); }
         size_type max_size() { return Base::max_size(); }
+        size_type capacity() const { return Base::capacity(); }
+        void reserve(size_type n) { Base::reserve(n); }
 
         // 23.3.1.2 element access:
         mapped_type& operator[](const key_type& key)
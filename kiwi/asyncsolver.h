@@ -0,0 +1,296 @@
+/*-----------------------------------------------------------------------------
+| Copyright (c) 2013-2026, Nucleic Development Team.
+|
+| Distributed under the terms of the Modified BSD License.
+|
+| The full license is in the file LICENSE, distributed with this software.
+|----------------------------------------------------------------------------*/
+#pragma once
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "solver.h"
+#include "variable.h"
+
+
+namespace kiwi
+{
+
+/*
+Implementation note
+===================
+Each edit variable has a slot in the mailbox, which holds the last value
+posted for it. Posting stores the value and then bumps the generation
+counter with a release operation, so a solver thread which reads the
+counter with an acquire load sees every value posted up to that
+generation. The solver thread applies the slots which changed since the
+previous batch, solves once, and publishes the generation it read. Only
+a producer which finds the solver thread asleep takes the lock, to wake
+it up.
+
+The variables are written by the solver thread. Their values are safe to
+read from the callback, or once the future of a generation is ready and
+until the next post. Other threads should read a ValueSnapshot published
+from the callback. Unless KIWI_ATOMIC_REFCOUNT is defined, copying or
+destroying a variable also used by the solver thread is a data race on
+its reference count.
+*/
+class AsyncSolver
+{
+
+public:
+
+	using Generation = std::uint64_t;
+
+	/* Start a solver thread for the given solver and edit variables.
+
+	The edit variables must have been added to the solver. The solver
+	must outlive this object, and must only be accessed through
+	`withSolver` while this object exists. An edit variable is left at
+	its suggested value until a value is posted for it.
+
+	*/
+	AsyncSolver( Solver& solver, std::vector<Variable> edits ) :
+		m_solver( solver ),
+		m_edits( std::move( edits ) ),
+		m_slots( new Slot[ m_edits.size() ] ),
+		m_applied( m_edits.size() ),
+		m_posted( 0 ),
+		m_solved( 0 ),
+		m_sleeping( false ),
+		m_stop( false )
+	{
+		const double unset = std::numeric_limits<double>::quiet_NaN();
+		for( std::size_t i = 0; i < m_edits.size(); ++i )
+		{
+			m_slots[ i ].value.store( unset, std::memory_order_relaxed );
+			m_applied[ i ] = unset;
+		}
+		m_thread = std::thread( &AsyncSolver::work, this );
+	}
+
+	AsyncSolver( const AsyncSolver& ) = delete;
+
+	AsyncSolver& operator=( const AsyncSolver& ) = delete;
+
+	/* Stop the solver thread.
+
+	Values posted but not solved yet are dropped.
+
+	*/
+	~AsyncSolver()
+	{
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		m_thread.join();
+	}
+
+	/* Post a value for the edit variable at the given index.
+
+	Only the last value posted for an edit variable is applied. Returns
+	the generation of the post, which can be waited on with `solved`.
+
+	*/
+	Generation post( std::size_t index, double value )
+	{
+		m_slots[ index ].value.store( value, std::memory_order_relaxed );
+		Generation generation = m_posted.fetch_add( 1, std::memory_order_seq_cst ) + 1;
+		if( m_sleeping.load( std::memory_order_seq_cst ) )
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			m_wake.notify_one();
+		}
+		return generation;
+	}
+
+	/* Post a value for the given edit variable.
+
+	Throws
+	------
+	UnknownEditVariable
+		The edit variable was not given to the constructor.
+
+	*/
+	Generation post( const Variable& variable, double value )
+	{
+		for( std::size_t i = 0; i < m_edits.size(); ++i )
+		{
+			if( m_edits[ i ].equals( variable ) )
+				return post( i, value );
+		}
+		throw UnknownEditVariable( variable );
+	}
+
+	/* The last generation covered by a solution.
+
+	*/
+	Generation solvedGeneration() const
+	{
+		return m_solved.load( std::memory_order_acquire );
+	}
+
+	/* Get a future which is ready once a solution covers the generation.
+
+	The future holds the exception thrown by the solver, if any. For a
+	generation already solved, it is the outcome of the last solve.
+
+	*/
+	std::shared_future<void> solved( Generation generation )
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		if( generation <= m_solved.load( std::memory_order_relaxed ) )
+		{
+			std::promise<void> promise;
+			if( m_error )
+				promise.set_exception( m_error );
+			else
+				promise.set_value();
+			return promise.get_future().share();
+		}
+		auto it = m_waiting.find( generation );
+		if( it == m_waiting.end() )
+		{
+			std::promise<void> promise;
+			std::shared_future<void> future( promise.get_future().share() );
+			it = m_waiting.insert( std::make_pair(
+				generation, std::make_pair( std::move( promise ), future ) ) ).first;
+		}
+		return it->second.second;
+	}
+
+	/* Set a callback run on the solver thread after each solution.
+
+	The callback receives the generation covered by the solution. It
+	holds the solver lock, so it must not call `withSolver`.
+
+	*/
+	void setCallback( std::function<void( Generation )> callback )
+	{
+		std::lock_guard<std::mutex> lock( m_solver_mutex );
+		m_callback = std::move( callback );
+	}
+
+	/* Run a function with exclusive access to the solver.
+
+	This is the way to add or remove constraints while the solver thread
+	runs. The values posted meanwhile are applied afterwards.
+
+	*/
+	template<typename F>
+	auto withSolver( F&& f ) -> decltype( f( std::declval<Solver&>() ) )
+	{
+		std::lock_guard<std::mutex> lock( m_solver_mutex );
+		return f( m_solver );
+	}
+
+private:
+
+	struct Slot
+	{
+		std::atomic<double> value;
+	};
+
+	using Waiting = std::map<Generation, std::pair<std::promise<void>, std::shared_future<void>>>;
+
+	void work()
+	{
+		while( true )
+		{
+			Generation generation = m_posted.load( std::memory_order_acquire );
+			if( generation == m_solved.load( std::memory_order_relaxed ) )
+			{
+				std::unique_lock<std::mutex> lock( m_mutex );
+				m_sleeping.store( true, std::memory_order_seq_cst );
+				m_wake.wait( lock, [this, generation] {
+					return m_stop ||
+						m_posted.load( std::memory_order_seq_cst ) != generation;
+				} );
+				m_sleeping.store( false, std::memory_order_relaxed );
+				if( m_stop )
+					return;
+				continue;
+			}
+			solve( generation );
+		}
+	}
+
+	void solve( Generation generation )
+	{
+		std::exception_ptr error;
+		{
+			std::lock_guard<std::mutex> lock( m_solver_mutex );
+			try
+			{
+				for( std::size_t i = 0; i < m_edits.size(); ++i )
+				{
+					double value = m_slots[ i ].value.load( std::memory_order_relaxed );
+					if( !std::isnan( value ) && value != m_applied[ i ] )
+					{
+						m_solver.suggestValue( m_edits[ i ], value );
+						m_applied[ i ] = value;
+					}
+				}
+				m_solver.updateVariables();
+			}
+			catch( ... )
+			{
+				error = std::current_exception();
+			}
+			if( !error && m_callback )
+				m_callback( generation );
+		}
+
+		Waiting ready;
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			m_solved.store( generation, std::memory_order_release );
+			m_error = error;
+			auto end = m_waiting.upper_bound( generation );
+			for( auto it = m_waiting.begin(); it != end; )
+			{
+				ready.insert( std::move( *it ) );
+				it = m_waiting.erase( it );
+			}
+		}
+		for( auto& readyPair : ready )
+		{
+			if( error )
+				readyPair.second.first.set_exception( error );
+			else
+				readyPair.second.first.set_value();
+		}
+	}
+
+	Solver& m_solver;
+	std::vector<Variable> m_edits;
+	std::unique_ptr<Slot[]> m_slots;
+	std::vector<double> m_applied;
+	std::atomic<Generation> m_posted;
+	std::atomic<Generation> m_solved;
+	std::atomic<bool> m_sleeping;
+	bool m_stop;
+	std::exception_ptr m_error;
+	Waiting m_waiting;
+	std::function<void( Generation )> m_callback;
+	std::mutex m_mutex;
+	std::mutex m_solver_mutex;
+	std::condition_variable m_wake;
+	std::thread m_thread;
+};
+
+} // namespace kiwi
@@ -0,0 +1,47 @@
+/*-----------------------------------------------------------------------------
+| Copyright (c) 2013-2026, Nucleic Development Team.
+|
+| Distributed under the terms of the Modified BSD License.
+|
+| The full license is in the file LICENSE, distributed with this software.
+|----------------------------------------------------------------------------*/
+#pragma once
+#include <chrono>
+#include <cstddef>
+
+namespace kiwi
+{
+
+/* A bound on the work done by a solve.
+
+The solve stops before the pivot which would exceed `maxPivots`, or
+before the first pivot started after `deadline`. A `maxPivots` of zero
+does not bound the number of pivots.
+
+*/
+struct Budget
+{
+    using Clock = std::chrono::steady_clock;
+
+    Budget(std::size_t maxPivots = 0, Clock::time_point deadline = Clock::time_point::max())
+        : maxPivots(maxPivots), deadline(deadline) {}
+
+    // A budget which expires after the given duration from now.
+    template <typename Rep, typename Period>
+    static Budget within(std::chrono::duration<Rep, Period> duration, std::size_t maxPivots = 0)
+    {
+        return Budget(maxPivots, Clock::now() + std::chrono::duration_cast<Clock::duration>(duration));
+    }
+
+    bool exhausted(std::size_t pivots) const
+    {
+        if (maxPivots != 0 && pivots >= maxPivots)
+            return true;
+        return deadline != Clock::time_point::max() && Clock::now() >= deadline;
+    }
+
+    std::size_t maxPivots;
+    Clock::time_point deadline;
+};
+
+} // namespace kiwi
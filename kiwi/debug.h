@@ -35,7 +35,7 @@ public:
         out << std::endl;
         out << "Infeasible" << std::endl;
         out << "----------" << std::endl;
-        dump(solver.m_infeasible_rows, out);
+        dump(solver.m_infeasible_rows.symbols(), out);
         out << std::endl;
         out << "Variables" << std::endl;
         out << "---------" << std::endl;
@@ -0,0 +1,141 @@
+/*-----------------------------------------------------------------------------
+| Copyright (c) 2013-2026, Nucleic Development Team.
+|
+| Distributed under the terms of the Modified BSD License.
+|
+| The full license is in the file LICENSE, distributed with this software.
+|----------------------------------------------------------------------------*/
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "symbol.h"
+
+
+namespace kiwi
+{
+
+namespace impl
+{
+
+/*
+Implementation note
+===================
+The queue holds the basic symbols of the rows which may be infeasible,
+ordered by the row constant so that the most infeasible row is popped
+first. A symbol is held at most once: a hash map from the ids of the
+queued symbols to the last constant pushed for them tracks membership in
+constant time, and its size is bounded by the queue rather than by the
+largest symbol id. Pushing a member with a new constant adds a fresh
+heap entry and leaves the previous one stale; stale entries are dropped
+lazily by pop.
+*/
+class InfeasibleQueue
+{
+
+public:
+
+	InfeasibleQueue() = default;
+
+	bool empty() const
+	{
+		return m_keys.empty();
+	}
+
+	/* The number of distinct symbols in the queue.
+
+	*/
+	std::size_t size() const
+	{
+		return m_keys.size();
+	}
+
+	/* Add a symbol with the current constant of its row.
+
+	If the symbol is already queued, its priority is updated.
+
+	*/
+	void push( const Symbol& symbol, double constant )
+	{
+		auto result = m_keys.emplace( symbol.id(), constant );
+		if( !result.second )
+		{
+			if( result.first->second == constant )
+				return;
+			result.first->second = constant;
+		}
+		m_heap.push_back( Entry( symbol, constant ) );
+		std::push_heap( m_heap.begin(), m_heap.end() );
+	}
+
+	/* Remove the symbol with the most negative constant.
+
+	Returns false if the queue is empty.
+
+	*/
+	bool pop( Symbol& symbol )
+	{
+		while( !m_heap.empty() )
+		{
+			std::pop_heap( m_heap.begin(), m_heap.end() );
+			Entry entry( m_heap.back() );
+			m_heap.pop_back();
+			auto it = m_keys.find( entry.symbol.id() );
+			if( it != m_keys.end() && it->second == entry.key )
+			{
+				m_keys.erase( it );
+				symbol = entry.symbol;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void clear()
+	{
+		m_heap.clear();
+		m_keys.clear();
+	}
+
+	/* The queued symbols, in no particular order.
+
+	*/
+	std::vector<Symbol> symbols() const
+	{
+		std::vector<Symbol> result;
+		for( const auto& entry : m_heap )
+		{
+			auto it = m_keys.find( entry.symbol.id() );
+			if( it != m_keys.end() && it->second == entry.key )
+				result.push_back( entry.symbol );
+		}
+		return result;
+	}
+
+private:
+
+	struct Entry
+	{
+		Entry( const Symbol& s, double k ) : symbol( s ), key( k ) {}
+
+		Symbol symbol;
+		double key;
+
+		// std::push_heap builds a max-heap, so the most negative key
+		// must compare as the largest.
+		friend bool operator<( const Entry& lhs, const Entry& rhs )
+		{
+			if( lhs.key != rhs.key )
+				return lhs.key > rhs.key;
+			return rhs.symbol < lhs.symbol;
+		}
+	};
+
+	std::vector<Entry> m_heap;
+	std::unordered_map<Symbol::Id, double> m_keys;
+};
+
+} // namespace impl
+
+} // namespace kiwi
@@ -6,13 +6,19 @@
 | The full license is in the file LICENSE, distributed with this software.
 |----------------------------------------------------------------------------*/
 #pragma once
+#include "asyncsolver.h"
+#include "budget.h"
 #include "constraint.h"
 #include "debug.h"
 #include "errors.h"
 #include "expression.h"
+#include "pivotlock.h"
 #include "shareddata.h"
 #include "solver.h"
+#include "stats.h"
 #include "strength.h"
+#include "sweeptable.h"
+#include "valuesnapshot.h"
 #include "symbolics.h"
 #include "term.h"
 #include "variable.h"
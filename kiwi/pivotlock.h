@@ -0,0 +1,37 @@
+/*-----------------------------------------------------------------------------
+| Copyright (c) 2026, Nucleic Development Team.
+|
+| Distributed under the terms of the Modified BSD License.
+|
+| The full license is in the file LICENSE, distributed with this software.
+|----------------------------------------------------------------------------*/
+#pragma once
+
+namespace kiwi
+{
+
+/* A lock of the caller which the solver releases while it pivots.
+
+The pivots of an operation only touch the tableau of the solver: no
+Variable, Constraint or Expression is copied or destroyed, and no value
+is written to a variable. A caller which serializes its use of the kiwi
+objects with a lock of its own, such as the GIL of Python, can have the
+solver release that lock during the pivots, which make up most of the
+work of a large solver, even when the reference counts are not atomic.
+
+*/
+class PivotLock
+{
+
+public:
+
+    virtual ~PivotLock() = default;
+
+    // Called before the pivots of an operation start.
+    virtual void unlock() = 0;
+
+    // Called once they are over, before the operation returns or throws.
+    virtual void lock() = 0;
+};
+
+} // namespace kiwi
@@ -98,6 +98,15 @@ public:
     {
         m_constant += other.m_constant * coefficient;
 
+        // Inserting cell by cell costs a binary search and a memmove of
+        // the tail per cell, while merging costs a single pass over both
+        // rows. The merge wins as soon as the other row is not tiny.
+        if (other.m_cells.size() > merge_threshold)
+        {
+            merge(other, coefficient);
+            return;
+        }
+
         for (const auto & cellPair : other.m_cells)
         {
             double coeff = cellPair.second * coefficient;
@@ -197,6 +206,57 @@ public:
     }
 
 private:
+    // The size of the inserted row above which insert() merges the rows.
+    static const CellMap::size_type merge_threshold = 4;
+
+    /* Add the cells of the other row times the coefficient by merging.
+
+    Both cell maps are sorted by symbol, so the result is built in a
+    single linear pass into a new map which then replaces the cells.
+
+    */
+    void merge(const Row &other, double coefficient)
+    {
+        CellMap merged;
+        merged.reserve(m_cells.size() + other.m_cells.size());
+        CellMap::const_iterator first = m_cells.begin();
+        CellMap::const_iterator last = m_cells.end();
+        CellMap::const_iterator ofirst = other.m_cells.begin();
+        CellMap::const_iterator olast = other.m_cells.end();
+        while (first != last && ofirst != olast)
+        {
+            if (first->first < ofirst->first)
+            {
+                merged.insert(merged.end(), *first);
+                ++first;
+            }
+            else if (ofirst->first < first->first)
+            {
+                double coeff = ofirst->second * coefficient;
+                if (!nearZero(coeff))
+                    merged.insert(merged.end(), CellMap::value_type(ofirst->first, coeff));
+                ++ofirst;
+            }
+            else
+            {
+                double coeff = first->second + ofirst->second * coefficient;
+                if (!nearZero(coeff))
+                    merged.insert(merged.end(), CellMap::value_type(first->first, coeff));
+                ++first;
+                ++ofirst;
+            }
+        }
+        for (; first != last; ++first)
+            merged.insert(merged.end(), *first);
+        for (; ofirst != olast; ++ofirst)
+        {
+            double coeff = ofirst->second * coefficient;
+            if (!nearZero(coeff))
+                merged.insert(merged.end(), CellMap::value_type(ofirst->first, coeff));
+        }
+        m_cells.swap(merged);
+    }
+
     CellMap m_cells;
     double m_constant;
 };
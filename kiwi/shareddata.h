@@ -6,6 +6,9 @@
 | The full license is in the file LICENSE, distributed with this software.
 |----------------------------------------------------------------------------*/
 #pragma once
+#if defined(KIWI_ATOMIC_REFCOUNT)
+#include <atomic>
+#endif
 
 /*
 Implementation note
@@ -15,6 +18,12 @@ but do not use atomic counters under the hood.
 Since kiwi operates within a single thread context, atomic counters are not necessary,
 especially given the extra CPU cost.
 Therefore the use of SharedDataPtr/SharedData is preferred over std::shared_ptr.
+
+Defining KIWI_ATOMIC_REFCOUNT makes the counters atomic, so that variables,
+constraints and expressions can be copied on several threads at once, for
+example built on worker threads and handed to a solver on another one.
+Increments are relaxed and decrements acquire-release, as in std::shared_ptr.
+The macro must have the same value in every translation unit of a program.
 */
 
 namespace kiwi
@@ -30,7 +39,11 @@ public:
 
     SharedData(SharedData&& other) = delete;
 
+#if defined(KIWI_ATOMIC_REFCOUNT)
+    std::atomic<int> m_refcount;
+#else
     int m_refcount;
+#endif
 
     SharedData &operator=(const SharedData &other) = delete;
 
@@ -166,13 +179,26 @@ private:
     static void incref(T *data)
     {
         if (data)
+        {
+#if defined(KIWI_ATOMIC_REFCOUNT)
+            data->m_refcount.fetch_add(1, std::memory_order_relaxed);
+#else
             ++data->m_refcount;
+#endif
+        }
     }
 
     static void decref(T *data)
     {
-        if (data && --data->m_refcount == 0)
+        if (!data)
+            return;
+#if defined(KIWI_ATOMIC_REFCOUNT)
+        if (data->m_refcount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete data;
+#else
+        if (--data->m_refcount == 0)
             delete data;
+#endif
     }
 
     T *m_data;
@@ -0,0 +1,117 @@
+/*-----------------------------------------------------------------------------
+| Copyright (c) 2013-2026, Nucleic Development Team.
+|
+| Distributed under the terms of the Modified BSD License.
+|
+| The full license is in the file LICENSE, distributed with this software.
+|----------------------------------------------------------------------------*/
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "symbol.h"
+
+
+namespace kiwi
+{
+
+namespace impl
+{
+
+/*
+Implementation note
+===================
+The cache maps the suggested values of the edit variables, quantized by
+a tolerance, to the values of the solver variables and to the basis of
+the solution. It holds a handful of entries, so they are kept in a
+vector ordered from the most to the least recently used, and looked up
+linearly. The quantized values are kept as doubles: rounding to an
+integer type is undefined for values out of its range, and for the
+infinities and NaN, all of which can be suggested. A key holding a NaN
+never compares equal, so it always misses.
+*/
+class SolutionCache
+{
+
+public:
+
+	struct Entry
+	{
+		std::vector<double> key;
+		std::vector<double> values;
+		std::vector<Symbol> basis;
+	};
+
+	SolutionCache() : m_capacity( 0 ), m_tolerance( 1e-6 ) {}
+
+	/* Set the number of entries and the quantization step of the keys.
+
+	A capacity of zero disables the cache. The entries are dropped.
+
+	*/
+	void configure( std::size_t capacity, double tolerance )
+	{
+		m_capacity = capacity;
+		m_tolerance = tolerance > 0.0 ? tolerance : 1e-6;
+		m_entries.clear();
+	}
+
+	bool enabled() const
+	{
+		return m_capacity != 0;
+	}
+
+	double quantize( double value ) const
+	{
+		return std::round( value / m_tolerance );
+	}
+
+	/* Find the entry for the key and mark it as the most recently used.
+
+	Returns null if there is no such entry.
+
+	*/
+	const Entry* find( const std::vector<double>& key )
+	{
+		for( auto it = m_entries.begin(); it != m_entries.end(); ++it )
+		{
+			if( it->key == key )
+			{
+				std::rotate( m_entries.begin(), it, it + 1 );
+				return &m_entries.front();
+			}
+		}
+		return nullptr;
+	}
+
+	/* Insert an entry as the most recently used one.
+
+	The least recently used entry is evicted if the cache is full.
+
+	*/
+	void insert( Entry entry )
+	{
+		if( !enabled() )
+			return;
+		if( m_entries.size() == m_capacity )
+			m_entries.pop_back();
+		m_entries.insert( m_entries.begin(), std::move( entry ) );
+	}
+
+	void clear()
+	{
+		m_entries.clear();
+	}
+
+private:
+
+	std::size_t m_capacity;
+	double m_tolerance;
+	std::vector<Entry> m_entries;
+};
+
+} // namespace impl
+
+} // namespace kiwi
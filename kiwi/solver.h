@@ -6,9 +6,16 @@
 | The full license is in the file LICENSE, distributed with this software.
 |----------------------------------------------------------------------------*/
 #pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "budget.h"
 #include "constraint.h"
 #include "debug.h"
+#include "pivotlock.h"
 #include "solverimpl.h"
+#include "stats.h"
+#include "sweeptable.h"
 #include "variable.h"
 
 
@@ -40,6 +47,26 @@ public:
 		m_impl.addConstraint( constraint );
 	}
 
+	/* Add several constraints to the solver.
+
+	The pending work of the solver is completed once for the batch.
+	Either all the constraints are added, or none.
+
+	Throws
+	------
+	DuplicateConstraint
+		A constraint has already been added to the solver, or appears
+		twice in the batch.
+
+	UnsatisfiableConstraint
+		A required constraint cannot be satisfied.
+
+	*/
+	void addConstraints( const std::vector<Constraint>& constraints )
+	{
+		m_impl.addConstraints( constraints );
+	}
+
 	/* Remove a constraint from the solver.
 
 	Throws
@@ -53,6 +80,22 @@ public:
 		m_impl.removeConstraint( constraint );
 	}
 
+	/* Remove several constraints from the solver.
+
+	Either all the constraints are removed, or none.
+
+	Throws
+	------
+	UnknownConstraint
+		A constraint has not been added to the solver, or appears twice
+		in the batch.
+
+	*/
+	void removeConstraints( const std::vector<Constraint>& constraints )
+	{
+		m_impl.removeConstraints( constraints );
+	}
+
 	/* Test whether a constraint has been added to the solver.
 
 	*/
@@ -80,6 +123,25 @@ public:
 		m_impl.addEditVariable( variable, strength );
 	}
 
+	/* Add several edit variables to the solver, with their strengths.
+
+	Either all the edit variables are added, or none.
+
+	Throws
+	------
+	DuplicateEditVariable
+		An edit variable has already been added to the solver, or
+		appears twice in the batch.
+
+	BadRequiredStrength
+		A strength is >= required.
+
+	*/
+	void addEditVariables( const std::vector<std::pair<Variable, double>>& edits )
+	{
+		m_impl.addEditVariables( edits );
+	}
+
 	/* Remove an edit variable from the solver.
 
 	Throws
@@ -119,6 +181,91 @@ public:
 		m_impl.suggestValue( variable, value );
 	}
 
+	/* Suggest values for several edit variables.
+
+	The dual simplex runs once, after the last suggestion. No value is
+	suggested if one of the variables is not an edit variable.
+
+	Throws
+	------
+	UnknownEditVariable
+		A variable has not been added to the solver as an edit variable.
+
+	*/
+	void suggestValues( const std::vector<std::pair<Variable, double>>& suggestions )
+	{
+		m_impl.suggestValues( suggestions );
+	}
+
+	/* Compute the solution over a range of suggested values of an edit.
+
+	The returned table holds the values of all the variables of the
+	solver as piecewise linear functions of the suggested value of the
+	edit variable over [lower, upper]. It can be evaluated without the
+	solver, and stays valid until constraints or other suggestions are
+	changed. The suggested value of the edit is left unchanged.
+
+	Throws
+	------
+	UnknownEditVariable
+		The given edit variable has not been added to the solver.
+
+	*/
+	SweepTable sweep( const Variable& variable, double lower, double upper )
+	{
+		return m_impl.sweep( variable, lower, upper );
+	}
+
+	/* Suggest a value for the given edit variable within a budget.
+
+	The solve stops once the budget is exhausted, with the tableau left
+	in a consistent state, and this returns false. Call `resume` in a
+	later frame to complete it. Until the solve is complete,
+	`updateVariables` leaves the variables at their last solved values.
+	Adding or removing constraints, and an unbudgeted suggestion, first
+	complete the pending solve.
+
+	Throws
+	------
+	UnknownEditVariable
+		The given edit variable has not been added to the solver.
+
+	*/
+	bool suggestValue( const Variable& variable, double value, const Budget& budget )
+	{
+		return m_impl.suggestValue( variable, value, budget );
+	}
+
+	/* Continue a solve stopped by its budget.
+
+	Returns true once the solution is complete. The default budget is
+	unbounded.
+
+	*/
+	bool resume( const Budget& budget = Budget() )
+	{
+		return m_impl.resume( budget );
+	}
+
+	/* Enable a cache of the solutions for the suggested edit values.
+
+	When `capacity` is non-zero, `updateVariables` keeps the solutions
+	of the last `capacity` distinct tuples of suggested values. Values
+	which round to the same multiple of `tolerance` share an entry, so
+	a hit restores the solution computed for the first of them. While
+	the cache is enabled, suggestions are applied lazily, when the next
+	update misses the cache. If `reinstallBasis` is true, a hit also
+	moves the solver to the basis of the cached solution, so that later
+	small suggestions start from it. Any change to the constraints or
+	edit variables clears the cache. A capacity of zero, the default,
+	disables it.
+
+	*/
+	void setSolutionCache( std::size_t capacity, double tolerance = 1e-6, bool reinstallBasis = false )
+	{
+		m_impl.setSolutionCache( capacity, tolerance, reinstallBasis );
+	}
+
 	/* Update the values of the external solver variables.
 
 	*/
@@ -127,6 +274,96 @@ public:
 		m_impl.updateVariables();
 	}
 
+	/* Set the tableau size above which pivots are run in parallel.
+
+	When the tableau holds at least `rows` rows, the substitution and
+	the ratio test of each pivot are split across a persistent pool of
+	worker threads, shared by all the solvers. Smaller systems are always
+	solved sequentially. A value of zero disables the parallel code path.
+
+	*/
+	void setParallelThreshold( std::size_t rows )
+	{
+		m_impl.setParallelThreshold( rows );
+	}
+
+	/* Enable or disable the fill-in heuristic for pivot selection.
+
+	When enabled, the solver prefers pivots which densify the fewest
+	rows of the tableau, at the cost of counting the rows which use
+	each candidate subject. This keeps long-lived tableaux sparser.
+
+	*/
+	void setMinimizeFillIn( bool enabled )
+	{
+		m_impl.setMinimizeFillIn( enabled );
+	}
+
+	/* Set the lock released by the solver while it pivots.
+
+	The lock is unlocked before the pivots of each operation and locked
+	again once they are over. It must outlive its use by the solver. A
+	null lock, the default, is never touched.
+
+	*/
+	void setPivotLock( PivotLock* lock )
+	{
+		m_impl.setPivotLock( lock );
+	}
+
+	/* Rebuild the tableau from scratch for the current basis.
+
+	After many additions, removals and edits, the tableau rows pick up
+	small non-zero cells and grow denser than a fresh build of the same
+	constraints. This recomputes every row from the constraints while
+	keeping the current basis, so the solution does not change.
+
+	Throws
+	------
+	InternalSolverError
+		The current basis could not be reproduced. The tableau is left
+		untouched in that case.
+
+	*/
+	void refactor()
+	{
+		m_impl.refactor();
+	}
+
+	/* Set the number of pivots after which the tableau is refactored.
+
+	When non-zero, `refactor` is called automatically at the end of the
+	constraint addition or removal which brings the number of primal and
+	dual pivots since the last rebuild to at least `pivots`. The change
+	itself has succeeded by then, so a rebuild which fails is skipped
+	instead of throwing. Zero, the default, disables the automatic
+	rebuild.
+
+	*/
+	void setAutoRefactor( std::size_t pivots )
+	{
+		m_impl.setAutoRefactor( pivots );
+	}
+
+	/* The number of rows in the tableau.
+
+	Unlike `stats`, this does not walk the tableau, so it is cheap enough
+	to decide how to run each operation.
+
+	*/
+	std::size_t rowCount() const
+	{
+		return m_impl.rowCount();
+	}
+
+	/* Compute a summary of the tableau shape and of the pivot counts.
+
+	*/
+	SolverStats stats() const
+	{
+		return m_impl.stats();
+	}
+
 	/* Reset the solver to the empty starting condition.
 
 	This method resets the internal solver state to the empty starting
@@ -7,16 +7,28 @@
 |----------------------------------------------------------------------------*/
 #pragma once
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
 #include <limits>
 #include <memory>
+#include <thread>
+#include <utility>
 #include <vector>
+#include "budget.h"
 #include "constraint.h"
 #include "errors.h"
 #include "expression.h"
+#include "infeasiblequeue.h"
 #include "maptype.h"
+#include "pivotlock.h"
 #include "row.h"
+#include "solutioncache.h"
+#include "stats.h"
+#include "sweeptable.h"
 #include "symbol.h"
 #include "term.h"
+#include "threadpool.h"
 #include "util.h"
 #include "variable.h"
 
@@ -37,11 +49,41 @@ class SolverImpl
 		Symbol other;
 	};
 
+	struct ColumnEntry
+	{
+		ColumnEntry( const Symbol& s, Row* r, double f ) :
+			symbol( s ), row( r ), factor( f ) {}
+
+		Symbol symbol;
+		Row* row;
+		double factor;
+	};
+
+	/* The effect of an edit variable on the tableau for a given basis.
+
+	While the basis does not change, changing the suggested value of the
+	edit by delta adds delta * factor to the constant of every row of its
+	column. The column is cached along with the range of suggested values
+	over which the restricted rows of the column stay feasible.
+
+	*/
+	struct Sensitivity
+	{
+		Sensitivity() : epoch( 0 ), tick( 0 ), lower( 0.0 ), upper( 0.0 ) {}
+
+		std::size_t epoch;
+		std::size_t tick;
+		double lower;
+		double upper;
+		std::vector<ColumnEntry> column;
+	};
+
 	struct EditInfo
 	{
 		Tag tag;
 		Constraint constraint;
 		double constant;
+		Sensitivity sensitivity;
 	};
 
 	using VarMap = MapType<Variable, Symbol>;
@@ -52,6 +94,34 @@ class SolverImpl
 
 	using EditMap = MapType<Variable, EditInfo>;
 
+	struct LeavingCandidate
+	{
+		LeavingCandidate( RowMap::iterator end ) :
+			row( end ),
+			ratio( std::numeric_limits<double>::max() ),
+			length( std::numeric_limits<std::size_t>::max() ) {}
+
+		RowMap::iterator row;
+		double ratio;
+		std::size_t length;
+	};
+
+	// Release the pivot lock of the solver, if any, for its lifetime.
+	struct PivotUnlock
+	{
+		PivotUnlock( PivotLock* lock ) : m_lock( lock )
+		{
+			if( m_lock )
+				m_lock->unlock();
+		}
+		~PivotUnlock()
+		{
+			if( m_lock )
+				m_lock->lock();
+		}
+		PivotLock* m_lock;
+	};
+
 	struct DualOptimizeGuard
 	{
 		DualOptimizeGuard( SolverImpl& impl ) : m_impl( impl ) {}
@@ -61,7 +131,23 @@ class SolverImpl
 
 public:
 
-	SolverImpl() : m_objective( new Row() ), m_id_tick( 1 ) {}
+	SolverImpl() :
+		m_objective( new Row() ),
+		m_id_tick( 1 ),
+		m_pivots( 0 ),
+		m_dual_pivots( 0 ),
+		m_refactor_pivots( 0 ),
+		m_auto_refactor( 0 ),
+		m_parallel_threshold( default_parallel_threshold ),
+		m_minimize_fill_in( false ),
+		m_pivot_lock( nullptr ),
+		m_basis_epoch( 1 ),
+		m_suggest_tick( 1 ),
+		m_values_epoch( 0 ),
+		m_reinstall_basis( false ),
+		m_cache_hits( 0 ),
+		m_cache_misses( 0 ),
+		m_solve_pending( false ) {}
 
 	SolverImpl( const SolverImpl& ) = delete;
 
@@ -84,52 +170,70 @@ public:
 	{
 		if( m_cns.find( constraint ) != m_cns.end() )
 			throw DuplicateConstraint( constraint );
+		finishSolve();
+		applyDeferred();
+		m_solution_cache.clear();
+		basisChanged();
+		insertConstraint( constraint );
 
-		// Creating a row causes symbols to be reserved for the variables
-		// in the constraint. If this method exits with an exception,
-		// then its possible those variables will linger in the var map.
-		// Since its likely that those variables will be used in other
-		// constraints and since exceptional conditions are uncommon,
-		// i'm not too worried about aggressive cleanup of the var map.
-		Tag tag;
-		std::unique_ptr<Row> rowptr( createRow( constraint, tag ) );
-		Symbol subject( chooseSubject( *rowptr, tag ) );
+		// Optimizing after each constraint is added performs less
+		// aggregate work due to a smaller average system size. It
+		// also ensures the solver remains in a consistent state.
+		optimize( *m_objective );
+		autoRefactor();
+	}
 
-		// If chooseSubject could not find a valid entering symbol, one
-		// last option is available if the entire row is composed of
-		// dummy variables. If the constant of the row is zero, then
-		// this represents redundant constraints and the new dummy
-		// marker can enter the basis. If the constant is non-zero,
-		// then it represents an unsatisfiable constraint.
-		if( subject.type() == Symbol::Invalid && allDummies( *rowptr ) )
+	/* Add several constraints to the solver.
+
+	The pending work of the solver is completed once for the batch. The
+	objective is still optimized after each insertion, which keeps the
+	tableau as sparse as adding the constraints one at a time. Either
+	all the constraints are added, or none of them is.
+
+	Throws
+	------
+	DuplicateConstraint
+		A constraint has already been added to the solver, or appears
+		twice in the batch.
+
+	UnsatisfiableConstraint
+		A required constraint cannot be satisfied.
+
+	*/
+	void addConstraints( const std::vector<Constraint>& constraints )
+	{
+		for( const auto& constraint : constraints )
 		{
-			if( !nearZero( rowptr->constant() ) )
-				throw UnsatisfiableConstraint( constraint );
-			else
-				subject = tag.marker;
+			if( m_cns.find( constraint ) != m_cns.end() )
+				throw DuplicateConstraint( constraint );
 		}
-
-		// If an entering symbol still isn't found, then the row must
-		// be added using an artificial variable. If that fails, then
-		// the row represents an unsatisfiable constraint.
-		if( subject.type() == Symbol::Invalid )
+		std::vector<Constraint> sorted( constraints );
+		std::sort( sorted.begin(), sorted.end() );
+		auto duplicate = std::adjacent_find( sorted.begin(), sorted.end() );
+		if( duplicate != sorted.end() )
+			throw DuplicateConstraint( *duplicate );
+
+		finishSolve();
+		applyDeferred();
+		m_solution_cache.clear();
+		basisChanged();
+		std::size_t added = 0;
+		try
 		{
-			if( !addWithArtificialVariable( *rowptr ) )
-				throw UnsatisfiableConstraint( constraint );
+			for( ; added < constraints.size(); ++added )
+			{
+				insertConstraint( constraints[ added ] );
+				optimize( *m_objective );
+			}
 		}
-		else
+		catch( const UnsatisfiableConstraint& )
 		{
-			rowptr->solveFor( subject );
-			substitute( subject, *rowptr );
-			m_rows[ subject ] = rowptr.release();
+			for( std::size_t i = 0; i < added; ++i )
+				eraseConstraint( m_cns.find( constraints[ i ] ) );
+			optimize( *m_objective );
+			throw;
 		}
-
-		m_cns[ constraint ] = tag;
-
-		// Optimizing after each constraint is added performs less
-		// aggregate work due to a smaller average system size. It
-		// also ensures the solver remains in a consistent state.
-		optimize( *m_objective );
+		autoRefactor();
 	}
 
 	/* Remove a constraint from the solver.
@@ -146,38 +250,52 @@ public:
 		if( cn_it == m_cns.end() )
 			throw UnknownConstraint( constraint );
 
-		Tag tag( cn_it->second );
-		m_cns.erase( cn_it );
-
-		// Remove the error effects from the objective function
-		// *before* pivoting, or substitutions into the objective
-		// will lead to incorrect solver results.
-		removeConstraintEffects( constraint, tag );
-
-		// If the marker is basic, simply drop the row. Otherwise,
-		// pivot the marker into the basis and then drop the row.
-		auto row_it = m_rows.find( tag.marker );
-		if( row_it != m_rows.end() )
-		{
-			std::unique_ptr<Row> rowptr( row_it->second );
-			m_rows.erase( row_it );
-		}
-		else
-		{
-			row_it = getMarkerLeavingRow( tag.marker );
-			if( row_it == m_rows.end() )
-				throw InternalSolverError( "failed to find leaving row" );
-			Symbol leaving( row_it->first );
-			std::unique_ptr<Row> rowptr( row_it->second );
-			m_rows.erase( row_it );
-			rowptr->solveFor( leaving, tag.marker );
-			substitute( tag.marker, *rowptr );
-		}
+		finishSolve();
+		applyDeferred();
+		m_solution_cache.clear();
+		basisChanged();
+		eraseConstraint( cn_it );
 
 		// Optimizing after each constraint is removed ensures that the
 		// solver remains consistent. It makes the solver api easier to
 		// use at a small tradeoff for speed.
 		optimize( *m_objective );
+		autoRefactor();
+	}
+
+	/* Remove several constraints from the solver.
+
+	The objective is optimized once, after the last constraint. Either
+	all the constraints are removed, or none of them is.
+
+	Throws
+	------
+	UnknownConstraint
+		A constraint has not been added to the solver, or appears twice
+		in the batch.
+
+	*/
+	void removeConstraints( const std::vector<Constraint>& constraints )
+	{
+		for( const auto& constraint : constraints )
+		{
+			if( m_cns.find( constraint ) == m_cns.end() )
+				throw UnknownConstraint( constraint );
+		}
+		std::vector<Constraint> sorted( constraints );
+		std::sort( sorted.begin(), sorted.end() );
+		auto duplicate = std::adjacent_find( sorted.begin(), sorted.end() );
+		if( duplicate != sorted.end() )
+			throw UnknownConstraint( *duplicate );
+
+		finishSolve();
+		applyDeferred();
+		m_solution_cache.clear();
+		basisChanged();
+		for( const auto& constraint : constraints )
+			eraseConstraint( m_cns.find( constraint ) );
+		optimize( *m_objective );
+		autoRefactor();
 	}
 
 	/* Test whether a constraint has been added to the solver.
@@ -218,6 +336,53 @@ public:
 		m_edits[ variable ] = info;
 	}
 
+	/* Add several edit variables to the solver, with their strengths.
+
+	Either all the edit variables are added, or none of them is.
+
+	Throws
+	------
+	DuplicateEditVariable
+		An edit variable has already been added to the solver, or
+		appears twice in the batch.
+
+	BadRequiredStrength
+		A strength is >= required.
+
+	*/
+	void addEditVariables( const std::vector<std::pair<Variable, double>>& edits )
+	{
+		std::vector<Variable> variables;
+		std::vector<Constraint> constraints;
+		variables.reserve( edits.size() );
+		constraints.reserve( edits.size() );
+		for( const auto& edit : edits )
+		{
+			if( m_edits.find( edit.first ) != m_edits.end() )
+				throw DuplicateEditVariable( edit.first );
+			double strength = strength::clip( edit.second );
+			if( strength == strength::required )
+				throw BadRequiredStrength();
+			variables.push_back( edit.first );
+			constraints.push_back( Constraint( Expression( edit.first ), OP_EQ, strength ) );
+		}
+		std::sort( variables.begin(), variables.end() );
+		auto duplicate = std::adjacent_find( variables.begin(), variables.end(),
+			[]( const Variable& lhs, const Variable& rhs ) { return lhs.equals( rhs ); } );
+		if( duplicate != variables.end() )
+			throw DuplicateEditVariable( *duplicate );
+
+		addConstraints( constraints );
+		for( std::size_t i = 0; i < edits.size(); ++i )
+		{
+			EditInfo info;
+			info.tag = m_cns[ constraints[ i ] ];
+			info.constraint = constraints[ i ];
+			info.constant = 0.0;
+			m_edits[ edits[ i ].first ] = info;
+		}
+	}
+
 	/* Remove an edit variable from the solver.
 
 	Throws
@@ -260,38 +425,252 @@ public:
 		if( it == m_edits.end() )
 			throw UnknownEditVariable( variable );
 
+		// With the solution cache, the suggestions are only applied to
+		// the tableau when the cache misses, or before any operation
+		// which needs the tableau to be up to date.
+		if( m_solution_cache.enabled() )
+		{
+			finishSolve();
+			m_deferred[ variable ] = value;
+			return;
+		}
+
 		DualOptimizeGuard guard( *this );
-		EditInfo& info = it->second;
+		applySuggestion( it->second, value );
+	}
+
+	/* Suggest values for several edit variables.
+
+	The dual simplex runs once, after the last suggestion. No value is
+	suggested if one of the variables is not an edit variable.
+
+	Throws
+	------
+	UnknownEditVariable
+		A variable has not been added to the solver as an edit variable.
+
+	*/
+	void suggestValues( const std::vector<std::pair<Variable, double>>& suggestions )
+	{
+		for( const auto& suggestion : suggestions )
+		{
+			if( m_edits.find( suggestion.first ) == m_edits.end() )
+				throw UnknownEditVariable( suggestion.first );
+		}
+
+		if( m_solution_cache.enabled() )
+		{
+			finishSolve();
+			for( const auto& suggestion : suggestions )
+				m_deferred[ suggestion.first ] = suggestion.second;
+			return;
+		}
+
+		DualOptimizeGuard guard( *this );
+		for( const auto& suggestion : suggestions )
+			applySuggestion( m_edits.find( suggestion.first )->second, suggestion.second );
+	}
+
+	/* Suggest a value for the given edit variable within a budget.
+
+	This returns true if the solution is complete. Otherwise the dual
+	simplex stopped when the budget was exhausted, and `resume` must be
+	called to complete it. Until then, `updateVariables` leaves the
+	variables at their last complete values. The suggestions deferred by
+	the solution cache are applied along with this one.
+
+	Throws
+	------
+	UnknownEditVariable
+		The given edit variable has not been added to the solver.
+
+	*/
+	bool suggestValue( const Variable& variable, double value, const Budget& budget )
+	{
+		auto it = m_edits.find( variable );
+		if( it == m_edits.end() )
+			throw UnknownEditVariable( variable );
+
+		if( m_solution_cache.enabled() )
+		{
+			m_deferred[ variable ] = value;
+			for( const auto& deferredPair : m_deferred )
+				applySuggestion( m_edits.find( deferredPair.first )->second, deferredPair.second );
+			m_deferred.clear();
+		}
+		else
+			applySuggestion( it->second, value );
+		return dualOptimize( nullptr, &budget );
+	}
+
+	/* Continue a solve which was stopped by its budget.
+
+	This returns true if the solution is complete.
+
+	*/
+	bool resume( const Budget& budget )
+	{
+		return dualOptimize( nullptr, &budget );
+	}
+
+	/* Enable a cache of the solutions for the suggested edit values.
+
+	When `capacity` is non-zero, `updateVariables` keeps the solutions of
+	the last `capacity` distinct tuples of suggested values, quantized by
+	`tolerance`. Suggestions are recorded and only applied to the tableau
+	when the cache misses, so returning to a cached tuple restores the
+	variables without running the dual simplex. If `reinstallBasis` is
+	true, a hit also rebuilds the tableau for the cached basis, so that
+	later suggestions start from it. The cache is cleared by any change
+	to the constraints or edit variables.
+
+	*/
+	void setSolutionCache( std::size_t capacity, double tolerance, bool reinstallBasis )
+	{
+		applyDeferred();
+		m_solution_cache.configure( capacity, tolerance );
+		m_reinstall_basis = reinstallBasis;
+	}
+
+	/* Apply a suggested value to the tableau.
+
+	The rows which become infeasible are queued for the dual simplex,
+	which is left to the caller.
+
+	*/
+	void applySuggestion( EditInfo& info, double value )
+	{
+		Sensitivity& sensitivity = info.sensitivity;
+		if( sensitivity.epoch != m_basis_epoch )
+			buildColumn( info );
+		if( sensitivity.tick != m_suggest_tick )
+			computeRange( sensitivity, info.constant );
 		double delta = value - info.constant;
 		info.constant = value;
+		sensitivity.tick = ++m_suggest_tick;
 
-		// Check first if the positive error variable is basic.
-		auto row_it = m_rows.find( info.tag.marker );
-		if( row_it != m_rows.end() )
+		// Inside the range the basis stays feasible, and the suggestion
+		// reduces to an update of the constants of the column. Outside
+		// of it, the rows which become infeasible are handed over to
+		// the dual simplex.
+		if( value >= sensitivity.lower && value <= sensitivity.upper )
 		{
-			if( row_it->second->add( -delta ) < 0.0 )
-				m_infeasible_rows.push_back( row_it->first );
-			return;
+			for( auto& entry : sensitivity.column )
+				entry.row->add( delta * entry.factor );
+		}
+		else
+		{
+			for( auto& entry : sensitivity.column )
+			{
+				if( entry.row->add( delta * entry.factor ) < 0.0 &&
+					entry.symbol.type() != Symbol::External )
+					m_infeasible_rows.push( entry.symbol, entry.row->constant() );
+			}
 		}
+	}
 
-		// Check next if the negative error variable is basic.
-		row_it = m_rows.find( info.tag.other );
-		if( row_it != m_rows.end() )
+	/* Compute the solution over a range of suggested values of an edit.
+
+	This performs a parametric dual simplex over [lower, upper]: the
+	current basis is followed while it stays feasible, and at each
+	breakpoint the row which blocks it leaves the basis with a dual
+	pivot. The suggested value of the edit is restored afterwards, but
+	the solver may end up in a different optimal basis.
+
+	Throws
+	------
+	UnknownEditVariable
+		The given edit variable has not been added to the solver.
+
+	InternalSolverError
+		The basis could not be followed across a breakpoint.
+
+	*/
+	SweepTable sweep( const Variable& variable, double lower, double upper )
+	{
+		auto it = m_edits.find( variable );
+		if( it == m_edits.end() )
+			throw UnknownEditVariable( variable );
+		if( upper < lower )
+			std::swap( lower, upper );
+
+		double original = it->second.constant;
+		std::vector<Variable> variables;
+		std::vector<std::pair<Symbol, std::size_t>> indices;
+		variables.reserve( m_vars.size() );
+		indices.reserve( m_vars.size() );
+		for( const auto& varPair : m_vars )
 		{
-			if( row_it->second->add( delta ) < 0.0 )
-				m_infeasible_rows.push_back( row_it->first );
-			return;
+			indices.push_back( std::make_pair( varPair.second, variables.size() ) );
+			variables.push_back( varPair.first );
 		}
+		std::sort( indices.begin(), indices.end() );
+		SweepTable table( variables, lower );
+
+		std::vector<double> values( m_vars.size() );
+		std::vector<double> slopes( m_vars.size() );
+		std::size_t degenerate = 0;
+		finishSolve();
+		applyDeferred();
+		suggestNow( variable, lower );
+		try
+		{
+			EditInfo& info = m_edits.find( variable )->second;
+			Sensitivity& sensitivity = info.sensitivity;
+			while( true )
+			{
+				if( sensitivity.epoch != m_basis_epoch )
+					buildColumn( info );
+				computeRange( sensitivity, info.constant );
+				sensitivity.tick = m_suggest_tick;
 
-		// Otherwise update each row where the error variables exist.
-		for (const auto & rowPair : m_rows)
+				double end = std::min( sensitivity.upper, upper );
+				if( end > info.constant || end >= upper )
+				{
+					degenerate = 0;
+					sweepPiece( sensitivity, indices, values, slopes );
+					table.addPiece( end, values, slopes );
+					if( end >= upper )
+						break;
+					suggestNow( variable, end );
+				}
+				else if( ++degenerate > m_rows.size() )
+					throw InternalSolverError( "failed to follow the basis" );
+
+				// Pivot the first restricted row which blocks the basis.
+				const ColumnEntry* blocking = nullptr;
+				for( const auto& entry : sensitivity.column )
+				{
+					if( entry.factor < 0.0 && entry.symbol.type() != Symbol::External &&
+						nearZero( entry.row->constant() ) )
+					{
+						blocking = &entry;
+						break;
+					}
+				}
+				if( !blocking )
+					throw InternalSolverError( "failed to find the blocking row" );
+				Symbol leaving( blocking->symbol );
+				Symbol entering( getDualEnteringSymbol( *blocking->row ) );
+				if( entering.type() == Symbol::Invalid )
+					throw InternalSolverError( "failed to follow the basis" );
+				auto row_it = m_rows.find( leaving );
+				Row* row = row_it->second;
+				m_rows.erase( row_it );
+				row->solveFor( leaving, entering );
+				substitute( entering, *row );
+				m_rows[ entering ] = row;
+				++m_dual_pivots;
+				basisChanged();
+			}
+		}
+		catch( ... )
 		{
-			double coeff = rowPair.second->coefficientFor( info.tag.marker );
-			if( coeff != 0.0 &&
-				rowPair.second->add( delta * coeff ) < 0.0 &&
-				rowPair.first.type() != Symbol::External )
-				m_infeasible_rows.push_back( rowPair.first );
+			suggestNow( variable, original );
+			throw;
 		}
+		suggestNow( variable, original );
+		return table;
 	}
 
 	/* Update the values of the external solver variables.
@@ -299,19 +678,187 @@ public:
 	*/
 	void updateVariables()
 	{
-		auto row_end = m_rows.end();
+		// The tableau of an incomplete solve is not feasible.
+		if( m_solve_pending )
+			return;
 
-		for (auto &varPair : m_vars)
+		std::vector<double> key;
+		if( m_solution_cache.enabled() )
 		{
-			Variable& var = varPair.first;
-			auto row_it = m_rows.find( varPair.second );
-			if( row_it == row_end )
-				var.setValue( 0.0 );
-			else
-				var.setValue( row_it->second->constant() );
+			key = solutionKey();
+			if( const SolutionCache::Entry* entry = m_solution_cache.find( key ) )
+			{
+				++m_cache_hits;
+				if( m_reinstall_basis )
+					reinstallBasis( entry->basis );
+				std::size_t index = 0;
+				for( auto& varPair : m_vars )
+					varPair.first.setValue( entry->values[ index++ ] );
+				return;
+			}
+			++m_cache_misses;
+			applyDeferred();
+		}
+
+		// The row of each variable only changes with the basis, so the
+		// lookups are cached and repeated updates are a linear pass.
+		if( m_values_epoch != m_basis_epoch )
+		{
+			auto row_end = m_rows.end();
+			m_value_rows.clear();
+			m_value_rows.reserve( m_vars.size() );
+			for (const auto &varPair : m_vars)
+			{
+				auto row_it = m_rows.find( varPair.second );
+				m_value_rows.push_back( std::make_pair(
+					varPair.first, row_it == row_end ? nullptr : row_it->second ) );
+			}
+			m_values_epoch = m_basis_epoch;
+		}
+
+		for (auto &valueRow : m_value_rows)
+			valueRow.first.setValue( valueRow.second ? valueRow.second->constant() : 0.0 );
+
+		if( m_solution_cache.enabled() )
+		{
+			SolutionCache::Entry entry;
+			entry.key.swap( key );
+			entry.values.reserve( m_value_rows.size() );
+			for( const auto& valueRow : m_value_rows )
+				entry.values.push_back( valueRow.second ? valueRow.second->constant() : 0.0 );
+			entry.basis.reserve( m_rows.size() );
+			for( const auto& rowPair : m_rows )
+				entry.basis.push_back( rowPair.first );
+			m_solution_cache.insert( std::move( entry ) );
 		}
 	}
 
+	/* Rebuild the tableau from scratch for the current basis.
+
+	Every row is recomputed from the original constraints by eliminating
+	the current basic symbols, and the objective is rebuilt from the
+	constraint strengths. The solution and the basis are unchanged, but
+	the small non-zero cells accumulated by long sequences of pivots are
+	dropped, which restores the sparsity and the accuracy of a freshly
+	built tableau.
+
+	Throws
+	------
+	InternalSolverError
+		The current basis could not be reproduced. The tableau is left
+		untouched in that case.
+
+	*/
+	void refactor()
+	{
+		finishSolve();
+		applyDeferred();
+		std::vector<Symbol> basis;
+		basis.reserve( m_rows.size() );
+		for( const auto& rowPair : m_rows )
+			basis.push_back( rowPair.first );
+		installBasis( basis );
+	}
+
+	/* Rebuild the tableau from scratch for the given basis.
+
+	The basic symbols must be sorted and form a basis of the current
+	constraints. The rows take the current suggested values of the edit
+	variables, and may be infeasible if the basis is not feasible for
+	them. The tableau is left untouched if the rebuild fails.
+
+	*/
+	void installBasis( const std::vector<Symbol>& symbols )
+	{
+		// Map each edit constraint to its current suggested value, which
+		// was folded into the row constants by suggestValue.
+		MapType<Constraint, double> suggested;
+		for( const auto& editPair : m_edits )
+			suggested[ editPair.second.constraint ] = editPair.second.constant;
+
+		// The basis, with a flag marking the symbols which have been
+		// given a row by the rebuild.
+		MapType<Symbol, bool> basis;
+		for( const auto& symbol : symbols )
+			basis.insert( basis.end(), std::make_pair( symbol, false ) );
+
+		RowMap rows;
+		std::unique_ptr<Row> objective( new Row() );
+		for( const auto& cnPair : m_cns )
+			insertObjectiveErrors( *objective, cnPair.first, cnPair.second );
+
+		try
+		{
+			for( const auto& cnPair : m_cns )
+			{
+				auto it = suggested.find( cnPair.first );
+				double offset = it == suggested.end() ? 0.0 : it->second;
+				std::unique_ptr<Row> rowptr(
+					rebuildRow( cnPair.first, cnPair.second, offset, rows ) );
+
+				// Pivot on the unused basic symbol with the largest
+				// coefficient. A row without one is a combination of the
+				// rows already rebuilt, like the redundant rows which the
+				// artificial variable insertion drops.
+				auto pivot = basis.end();
+				double largest = 0.0;
+				for( const auto& cellPair : rowptr->cells() )
+				{
+					auto basic = basis.find( cellPair.first );
+					double magnitude = std::abs( cellPair.second );
+					if( basic != basis.end() && !basic->second && magnitude > largest )
+					{
+						largest = magnitude;
+						pivot = basic;
+					}
+				}
+				if( pivot == basis.end() )
+					continue;
+				pivot->second = true;
+				Symbol subject( pivot->first );
+				rowptr->solveFor( subject );
+				for( auto& rowPair : rows )
+					rowPair.second->substitute( subject, *rowptr );
+				objective->substitute( subject, *rowptr );
+				rows[ subject ] = rowptr.release();
+			}
+			if( rows.size() != symbols.size() )
+				throw InternalSolverError( "failed to rebuild the tableau" );
+		}
+		catch( ... )
+		{
+			std::for_each( rows.begin(), rows.end(), RowDeleter() );
+			throw;
+		}
+
+		clearRows();
+		m_rows.swap( rows );
+		m_objective.swap( objective );
+		basisChanged();
+		m_infeasible_rows.clear();
+		for( const auto& rowPair : m_rows )
+		{
+			if( rowPair.first.type() != Symbol::External &&
+				rowPair.second->constant() < 0.0 )
+				m_infeasible_rows.push( rowPair.first, rowPair.second->constant() );
+		}
+		m_refactor_pivots = m_pivots + m_dual_pivots;
+	}
+
+	/* Set the number of pivots after which the tableau is refactored.
+
+	When non-zero, the tableau is rebuilt with `refactor` at the end of
+	the first constraint addition or removal which brings the number of
+	primal and dual pivots since the last rebuild to at least `pivots`.
+	A rebuild which fails there is skipped rather than reported. A value
+	of zero, the default, disables the automatic rebuild.
+
+	*/
+	void setAutoRefactor( std::size_t pivots )
+	{
+		m_auto_refactor = pivots;
+	}
+
 	/* Reset the solver to the empty starting condition.
 
 	This method resets the internal solver state to the empty starting
@@ -331,14 +878,98 @@ public:
 		m_objective.reset( new Row() );
 		m_artificial.reset();
 		m_id_tick = 1;
+		m_pivots = 0;
+		m_dual_pivots = 0;
+		m_refactor_pivots = 0;
+		m_cache_hits = 0;
+		m_cache_misses = 0;
+		m_deferred.clear();
+		m_solution_cache.clear();
+		m_solve_pending = false;
+		basisChanged();
+	}
+
+	/* Set the tableau size above which pivots are run in parallel.
+
+	When the tableau holds at least `rows` rows, the substitution and
+	the ratio test of a pivot are split across the pool of worker threads
+	shared by all the solvers, which is created on first use. A value of zero disables the parallel
+	code path entirely. The result of a solve does not depend on this
+	setting.
+
+	*/
+	void setParallelThreshold( std::size_t rows )
+	{
+		m_parallel_threshold = rows;
+	}
+
+	/* Enable or disable the fill-in heuristic for pivot selection.
+
+	When enabled, the subject of a new row is the external variable which
+	appears in the fewest rows, and ties in the ratio test go to the
+	shortest row. Both choices minimize the Markowitz fill-in estimate
+	(row length - 1) * (column count - 1) of the pivot.
+
+	*/
+	void setMinimizeFillIn( bool enabled )
+	{
+		m_minimize_fill_in = enabled;
+	}
+
+	/* Set the lock released while the solver pivots.
+
+	*/
+	void setPivotLock( PivotLock* lock )
+	{
+		m_pivot_lock = lock;
+	}
+
+	/* The number of rows in the tableau.
+
+	*/
+	std::size_t rowCount() const
+	{
+		return m_rows.size();
+	}
+
+	/* Compute a summary of the tableau shape and of the pivot counts.
+
+	This walks the whole tableau and is meant for diagnostics.
+
+	*/
+	SolverStats stats() const
+	{
+		SolverStats stats;
+		std::vector<Symbol> columns;
+		for( const auto& rowPair : m_rows )
+		{
+			stats.cells += rowPair.second->cells().size();
+			for( const auto& cellPair : rowPair.second->cells() )
+				columns.push_back( cellPair.first );
+		}
+		std::sort( columns.begin(), columns.end() );
+		stats.rows = m_rows.size();
+		stats.columns = std::unique( columns.begin(), columns.end() ) - columns.begin();
+		stats.pivots = m_pivots;
+		stats.dualPivots = m_dual_pivots;
+		stats.cacheHits = m_cache_hits;
+		stats.cacheMisses = m_cache_misses;
+		return stats;
 	}
 
 	SolverImpl& operator=( const SolverImpl& ) = delete;
 
 	SolverImpl& operator=( SolverImpl&& ) = delete;
 
+	static const std::size_t default_parallel_threshold = 8192;
+
 private:
 
+	// The number of row chunks handed to each thread of the pool. Using
+	// more chunks than threads evens out the load when the rows differ
+	// in length.
+	static const std::size_t chunks_per_thread = 4;
+
 	struct RowDeleter
 	{
 		template<typename T>
@@ -375,80 +1006,364 @@ private:
 	variable is basic, the cell variable will be substituted with the
 	basic row.
 
-	The necessary slack and error variables will be added to the row.
-	If the constant for the row is negative, the sign for the row
-	will be inverted so the constant becomes positive.
+	The necessary slack and error variables will be added to the row.
+	If the constant for the row is negative, the sign for the row
+	will be inverted so the constant becomes positive.
+
+	The tag will be updated with the marker and error symbols to use
+	for tracking the movement of the constraint in the tableau.
+
+	*/
+	std::unique_ptr<Row> createRow( const Constraint& constraint, Tag& tag )
+	{
+		const Expression& expr( constraint.expression() );
+		std::unique_ptr<Row> row( new Row( expr.constant() ) );
+
+		// Substitute the current basic variables into the row.
+		for (const auto &term : expr.terms())
+		{
+			if( !nearZero( term.coefficient() ) )
+			{
+				Symbol symbol( getVarSymbol( term.variable() ) );
+				auto row_it = m_rows.find( symbol );
+				if( row_it != m_rows.end() )
+					row->insert( *row_it->second, term.coefficient() );
+				else
+					row->insert( symbol, term.coefficient() );
+			}
+		}
+
+		// Add the necessary slack, error, and dummy variables.
+		switch( constraint.op() )
+		{
+			case OP_LE:
+			case OP_GE:
+			{
+				double coeff = constraint.op() == OP_LE ? 1.0 : -1.0;
+				Symbol slack( Symbol::Slack, m_id_tick++ );
+				tag.marker = slack;
+				row->insert( slack, coeff );
+				if( constraint.strength() < strength::required )
+				{
+					Symbol error( Symbol::Error, m_id_tick++ );
+					tag.other = error;
+					row->insert( error, -coeff );
+					m_objective->insert( error, constraint.strength() );
+				}
+				break;
+			}
+			case OP_EQ:
+			{
+				if( constraint.strength() < strength::required )
+				{
+					Symbol errplus( Symbol::Error, m_id_tick++ );
+					Symbol errminus( Symbol::Error, m_id_tick++ );
+					tag.marker = errplus;
+					tag.other = errminus;
+					row->insert( errplus, -1.0 ); // v = eplus - eminus
+					row->insert( errminus, 1.0 ); // v - eplus + eminus = 0
+					m_objective->insert( errplus, constraint.strength() );
+					m_objective->insert( errminus, constraint.strength() );
+				}
+				else
+				{
+					Symbol dummy( Symbol::Dummy, m_id_tick++ );
+					tag.marker = dummy;
+					row->insert( dummy );
+				}
+				break;
+			}
+		}
+
+		// Ensure the row as a positive constant.
+		if( row->constant() < 0.0 )
+			row->reverseSign();
+
+		return row;
+	}
+
+	/* Insert the error symbols of a constraint into an objective row.
+
+	This mirrors the objective terms added by createRow.
+
+	*/
+	static void insertObjectiveErrors( Row& objective, const Constraint& constraint, const Tag& tag )
+	{
+		if( tag.marker.type() == Symbol::Error )
+			objective.insert( tag.marker, constraint.strength() );
+		if( tag.other.type() == Symbol::Error )
+			objective.insert( tag.other, constraint.strength() );
+	}
+
+	/* Recreate the row of a constraint for the refactor operation.
+
+	The row is built from the constraint expression and the existing tag
+	symbols, with the same coefficients as createRow. The `offset` is the
+	value suggested for an edit constraint. Symbols which are basic in
+	`rows` are substituted with their row.
+
+	*/
+	std::unique_ptr<Row> rebuildRow( const Constraint& constraint,
+									 const Tag& tag,
+									 double offset,
+									 const RowMap& rows ) const
+	{
+		const Expression& expr( constraint.expression() );
+		std::unique_ptr<Row> row( new Row( expr.constant() - offset ) );
+		auto insert = [&]( const Symbol& symbol, double coefficient ) {
+			auto row_it = rows.find( symbol );
+			if( row_it != rows.end() )
+				row->insert( *row_it->second, coefficient );
+			else
+				row->insert( symbol, coefficient );
+		};
+
+		for( const auto& term : expr.terms() )
+		{
+			if( !nearZero( term.coefficient() ) )
+				insert( m_vars.find( term.variable() )->second, term.coefficient() );
+		}
+		switch( constraint.op() )
+		{
+			case OP_LE:
+			case OP_GE:
+			{
+				double coeff = constraint.op() == OP_LE ? 1.0 : -1.0;
+				insert( tag.marker, coeff );
+				if( tag.other.type() == Symbol::Error )
+					insert( tag.other, -coeff );
+				break;
+			}
+			case OP_EQ:
+			{
+				if( tag.marker.type() == Symbol::Error )
+				{
+					insert( tag.marker, -1.0 );
+					insert( tag.other, 1.0 );
+				}
+				else
+					insert( tag.marker, 1.0 );
+				break;
+			}
+		}
+		return row;
+	}
+
+	/* Complete a solve which was stopped by its budget.
+
+	*/
+	void finishSolve()
+	{
+		if( m_solve_pending )
+			dualOptimize();
+	}
+
+	/* Apply the suggestions deferred by the solution cache.
+
+	*/
+	void applyDeferred()
+	{
+		if( m_deferred.empty() )
+			return;
+		DualOptimizeGuard guard( *this );
+		for( const auto& deferredPair : m_deferred )
+			applySuggestion( m_edits.find( deferredPair.first )->second, deferredPair.second );
+		m_deferred.clear();
+	}
+
+	/* Apply a suggested value to the tableau and restore feasibility.
+
+	*/
+	void suggestNow( const Variable& variable, double value )
+	{
+		DualOptimizeGuard guard( *this );
+		applySuggestion( m_edits.find( variable )->second, value );
+	}
+
+	/* Compute the cache key of the current suggested values.
+
+	*/
+	std::vector<double> solutionKey() const
+	{
+		std::vector<double> key;
+		key.reserve( m_edits.size() );
+		for( const auto& editPair : m_edits )
+		{
+			auto it = m_deferred.find( editPair.first );
+			double value = it == m_deferred.end() ? editPair.second.constant : it->second;
+			key.push_back( m_solution_cache.quantize( value ) );
+		}
+		return key;
+	}
+
+	/* Bring the tableau to a cached basis for the current suggestions.
+
+	If the basis is already the current one, applying the suggestions
+	only moves the constants. Otherwise the tableau is rebuilt for the
+	basis, which is optimal since the objective does not depend on the
+	suggestions, and the dual simplex removes the infeasibilities left by
+	the quantization of the key. If the rebuild fails, the suggestions
+	are applied to the current basis instead.
+
+	*/
+	void reinstallBasis( const std::vector<Symbol>& basis )
+	{
+		if( m_deferred.empty() )
+			return;
+		bool current = basis.size() == m_rows.size();
+		for( std::size_t i = 0; current && i < basis.size(); ++i )
+			current = ( m_rows.begin() + i )->first == basis[ i ];
+		if( !current )
+		{
+			std::vector<std::pair<EditInfo*, double>> applied;
+			for( const auto& deferredPair : m_deferred )
+			{
+				EditInfo& info = m_edits.find( deferredPair.first )->second;
+				applied.push_back( std::make_pair( &info, info.constant ) );
+				info.constant = deferredPair.second;
+			}
+			try
+			{
+				DualOptimizeGuard guard( *this );
+				installBasis( basis );
+				m_deferred.clear();
+				return;
+			}
+			catch( const InternalSolverError& )
+			{
+				for( const auto& appliedPair : applied )
+					appliedPair.first->constant = appliedPair.second;
+			}
+		}
+		applyDeferred();
+	}
+
+	/* Record a change of the basis or of the shape of the tableau.
+
+	This invalidates the cached columns of the edit variables and the
+	cached rows of the variables.
+
+	*/
+	void basisChanged()
+	{
+		++m_basis_epoch;
+		m_value_rows.clear();
+	}
+
+	/* Compute the column of an edit variable for the current basis.
+
+	*/
+	void buildColumn( EditInfo& info )
+	{
+		Sensitivity& sensitivity = info.sensitivity;
+		sensitivity.epoch = m_basis_epoch;
+		sensitivity.tick = 0;
+		sensitivity.column.clear();
+
+		// If one of the error variables is basic, its row is the only
+		// one which depends on the suggested value. Otherwise every row
+		// where the positive error variable exists is affected.
+		auto row_it = m_rows.find( info.tag.marker );
+		if( row_it != m_rows.end() )
+		{
+			sensitivity.column.push_back( ColumnEntry( row_it->first, row_it->second, -1.0 ) );
+			return;
+		}
+		row_it = m_rows.find( info.tag.other );
+		if( row_it != m_rows.end() )
+		{
+			sensitivity.column.push_back( ColumnEntry( row_it->first, row_it->second, 1.0 ) );
+			return;
+		}
+		for( const auto& rowPair : m_rows )
+		{
+			double coeff = rowPair.second->coefficientFor( info.tag.marker );
+			if( coeff != 0.0 )
+				sensitivity.column.push_back( ColumnEntry( rowPair.first, rowPair.second, coeff ) );
+		}
+	}
+
+	/* Compute the range of suggested values which keep the basis feasible.
+
+	The range is expressed in suggested values, so it is unchanged by
+	suggestions made for the same edit variable. It must be recomputed
+	when the constants are changed by any other suggestion.
+
+	*/
+	static void computeRange( Sensitivity& sensitivity, double current )
+	{
+		double lower = -std::numeric_limits<double>::max();
+		double upper = std::numeric_limits<double>::max();
+		for( const auto& entry : sensitivity.column )
+		{
+			if( entry.symbol.type() == Symbol::External )
+				continue;
+			double bound = current - entry.row->constant() / entry.factor;
+			if( entry.factor > 0.0 )
+				lower = std::max( lower, bound );
+			else
+				upper = std::min( upper, bound );
+		}
+		sensitivity.lower = lower;
+		sensitivity.upper = upper;
+	}
+
+	/* Compute the values of the variables and their slopes with respect
+	to the suggested value of an edit, for the current basis.
 
-	The tag will be updated with the marker and error symbols to use
-	for tracking the movement of the constraint in the tableau.
+	The values and slopes are stored in the order of the variable map.
+	`indices` maps the symbols of the variables to that order and is
+	sorted by symbol.
 
 	*/
-	std::unique_ptr<Row> createRow( const Constraint& constraint, Tag& tag )
+	void sweepPiece( const Sensitivity& sensitivity,
+					 const std::vector<std::pair<Symbol, std::size_t>>& indices,
+					 std::vector<double>& values,
+					 std::vector<double>& slopes ) const
 	{
-		const Expression& expr( constraint.expression() );
-		std::unique_ptr<Row> row( new Row( expr.constant() ) );
-
-		// Substitute the current basic variables into the row.
-		for (const auto &term : expr.terms())
+		auto row_end = m_rows.end();
+		std::size_t index = 0;
+		for( const auto& varPair : m_vars )
 		{
-			if( !nearZero( term.coefficient() ) )
-			{
-				Symbol symbol( getVarSymbol( term.variable() ) );
-				auto row_it = m_rows.find( symbol );
-				if( row_it != m_rows.end() )
-					row->insert( *row_it->second, term.coefficient() );
-				else
-					row->insert( symbol, term.coefficient() );
-			}
+			auto row_it = m_rows.find( varPair.second );
+			values[ index ] = row_it == row_end ? 0.0 : row_it->second->constant();
+			slopes[ index ] = 0.0;
+			++index;
 		}
 
-		// Add the necessary slack, error, and dummy variables.
-		switch( constraint.op() )
+		// The factor of a basic external in the column is the slope of
+		// its value.
+		for( const auto& entry : sensitivity.column )
 		{
-			case OP_LE:
-			case OP_GE:
-			{
-				double coeff = constraint.op() == OP_LE ? 1.0 : -1.0;
-				Symbol slack( Symbol::Slack, m_id_tick++ );
-				tag.marker = slack;
-				row->insert( slack, coeff );
-				if( constraint.strength() < strength::required )
-				{
-					Symbol error( Symbol::Error, m_id_tick++ );
-					tag.other = error;
-					row->insert( error, -coeff );
-					m_objective->insert( error, constraint.strength() );
-				}
-				break;
-			}
-			case OP_EQ:
-			{
-				if( constraint.strength() < strength::required )
-				{
-					Symbol errplus( Symbol::Error, m_id_tick++ );
-					Symbol errminus( Symbol::Error, m_id_tick++ );
-					tag.marker = errplus;
-					tag.other = errminus;
-					row->insert( errplus, -1.0 ); // v = eplus - eminus
-					row->insert( errminus, 1.0 ); // v - eplus + eminus = 0
-					m_objective->insert( errplus, constraint.strength() );
-					m_objective->insert( errminus, constraint.strength() );
-				}
-				else
-				{
-					Symbol dummy( Symbol::Dummy, m_id_tick++ );
-					tag.marker = dummy;
-					row->insert( dummy );
-				}
-				break;
-			}
+			if( entry.symbol.type() != Symbol::External )
+				continue;
+			auto it = std::lower_bound( indices.begin(), indices.end(),
+				std::make_pair( entry.symbol, std::size_t( 0 ) ) );
+			if( it != indices.end() && it->first == entry.symbol )
+				slopes[ it->second ] = entry.factor;
 		}
+	}
 
-		// Ensure the row as a positive constant.
-		if( row->constant() < 0.0 )
-			row->reverseSign();
+	/* Refactor the tableau if enough pivots were made since the last time.
 
-		return row;
+	This runs after a constraint has been committed, so a failed rebuild
+	must not be reported as a failure of the change. The tableau is left
+	as it is, and the next attempt waits for another full interval.
+
+	*/
+	void autoRefactor()
+	{
+		std::size_t pivots = m_pivots + m_dual_pivots - m_refactor_pivots;
+		if( m_auto_refactor == 0 || pivots < m_auto_refactor )
+			return;
+		try
+		{
+			refactor();
+		}
+		catch( const InternalSolverError& )
+		{
+			m_refactor_pivots = m_pivots + m_dual_pivots;
+		}
 	}
 
 	/* Choose the subject for solving for the row.
@@ -459,19 +1374,31 @@ private:
 
 	The symbols are chosen according to the following precedence:
 
-	1) The first symbol representing an external variable.
-	2) A negative slack or error tag variable.
+	1) The first external variable which is not yet in the tableau,
+	   i.e. whose id is at least `fresh_tick`.
+	2) The first symbol representing an external variable, or the one
+	   which appears in the fewest rows if the fill-in heuristic is
+	   enabled.
+	3) A negative slack or error tag variable.
 
 	If a subject cannot be found, an invalid symbol will be returned.
 
 	*/
-	Symbol chooseSubject( const Row& row, const Tag& tag ) const
+	Symbol chooseSubject( const Row& row, const Tag& tag, Symbol::Id fresh_tick ) const
 	{
+		Symbol external;
 		for (const auto &cellPair : row.cells())
 		{
 			if( cellPair.first.type() == Symbol::External )
-				return cellPair.first;
+			{
+				if( cellPair.first.id() >= fresh_tick )
+					return cellPair.first;
+				if( external.type() == Symbol::Invalid )
+					external = cellPair.first;
+			}
 		}
+		if( external.type() != Symbol::Invalid )
+			return m_minimize_fill_in ? leastFillInSubject( row ) : external;
 		if( tag.marker.type() == Symbol::Slack || tag.marker.type() == Symbol::Error )
 		{
 			if( row.coefficientFor( tag.marker ) < 0.0 )
@@ -485,6 +1412,226 @@ private:
 		return Symbol();
 	}
 
+	/* Get the external symbol of the row which appears in the fewest rows.
+
+	Substituting the subject into a row adds up to (row length - 1)
+	cells to it, so the subject with the smallest column count creates
+	the least fill-in. Ties go to the first symbol. The row must contain
+	at least one external symbol.
+
+	*/
+	Symbol leastFillInSubject( const Row& row ) const
+	{
+		std::vector<Symbol> candidates;
+		for( const auto& cellPair : row.cells() )
+		{
+			if( cellPair.first.type() == Symbol::External )
+				candidates.push_back( cellPair.first );
+		}
+		std::vector<std::size_t> counts( candidates.size(), 0 );
+		for( const auto& rowPair : m_rows )
+		{
+			for( std::size_t i = 0; i < candidates.size(); ++i )
+			{
+				if( rowPair.second->coefficientFor( candidates[ i ] ) != 0.0 )
+					++counts[ i ];
+			}
+		}
+		std::size_t best = 0;
+		for( std::size_t i = 1; i < candidates.size(); ++i )
+		{
+			if( counts[ i ] < counts[ best ] )
+				best = i;
+		}
+		return candidates[ best ];
+	}
+
+	/* Add a required inequality row to the tableau with its slack basic.
+
+	The slack of a row for which no subject could be chosen has a positive
+	coefficient, so solving for it gives a row whose constant is negative
+	if the constraint is violated by the current solution. The objective
+	is unchanged and still optimal, which is the starting point for the
+	dual simplex. This avoids the copies and the extra objective of the
+	artificial variable method.
+
+	This will return false if the constraint cannot be satisfied, in
+	which case the tableau is restored to its state before the call.
+
+	*/
+	bool addWithDualSimplex( std::unique_ptr<Row>& rowptr, const Symbol& slack )
+	{
+		// The slack is a fresh symbol, so it appears nowhere else in the
+		// tableau or in the objective and no substitution is needed.
+		rowptr->solveFor( slack );
+		double constant = rowptr->constant();
+		if( constant < 0.0 && !nearZero( constant ) )
+		{
+			// The row can only become feasible if some non-dummy symbol
+			// can increase the value of the slack.
+			bool pivotable = false;
+			for( const auto& cellPair : rowptr->cells() )
+			{
+				if( cellPair.second > 0.0 && cellPair.first.type() != Symbol::Dummy )
+				{
+					pivotable = true;
+					break;
+				}
+			}
+			if( !pivotable )
+				return false;
+			m_infeasible_rows.push( slack, constant );
+		}
+		m_rows[ slack ] = rowptr.release();
+
+		// The original system is feasible, so a failure of the dual
+		// simplex is caused by the new row. Undo the pivots to get back
+		// the original basis, in which the slack is basic again, and
+		// drop the row. The tableau of a basis is unique, so this
+		// restores the optimal and feasible original tableau.
+		std::vector<std::pair<Symbol, Symbol>> trail;
+		try
+		{
+			dualOptimize( &trail, nullptr );
+		}
+		catch( const InternalSolverError& )
+		{
+			for( auto it = trail.rbegin(); it != trail.rend(); ++it )
+			{
+				auto row_it = m_rows.find( it->second );
+				Row* row = row_it->second;
+				m_rows.erase( row_it );
+				row->solveFor( it->second, it->first );
+				substitute( it->first, *row );
+				m_rows[ it->first ] = row;
+			}
+			removeMarkerRow( slack );
+			m_infeasible_rows.clear();
+			return false;
+		}
+		return true;
+	}
+
+	/* Insert the rows of a constraint into the tableau.
+
+	The tableau is left primal feasible, but the objective is left to the
+	caller to optimize.
+
+	Throws
+	------
+	UnsatisfiableConstraint
+		The constraint is required and cannot be satisfied. It is not
+		added in that case.
+
+	*/
+	void insertConstraint( const Constraint& constraint )
+	{
+		// Creating a row causes symbols to be reserved for the variables
+		// in the constraint. If this method exits with an exception,
+		// then its possible those variables will linger in the var map.
+		// Since its likely that those variables will be used in other
+		// constraints and since exceptional conditions are uncommon,
+		// i'm not too worried about aggressive cleanup of the var map.
+		// Symbols with an id at or above this tick are created for this
+		// constraint, and so they do not appear in the tableau yet.
+		Symbol::Id fresh_tick = m_id_tick;
+		Tag tag;
+		std::unique_ptr<Row> rowptr( createRow( constraint, tag ) );
+		Symbol subject( chooseSubject( *rowptr, tag, fresh_tick ) );
+
+		// If chooseSubject could not find a valid entering symbol, one
+		// last option is available if the entire row is composed of
+		// dummy variables. If the constant of the row is zero, then
+		// this represents redundant constraints and the new dummy
+		// marker can enter the basis. If the constant is non-zero,
+		// then it represents an unsatisfiable constraint.
+		if( subject.type() == Symbol::Invalid && allDummies( *rowptr ) )
+		{
+			if( !nearZero( rowptr->constant() ) )
+				throw UnsatisfiableConstraint( constraint );
+			else
+				subject = tag.marker;
+		}
+
+		// If an entering symbol still isn't found, a required
+		// inequality can enter with its slack basic, and the dual
+		// simplex then restores feasibility. Any other row must be
+		// added using an artificial variable. If that fails, then the
+		// row represents an unsatisfiable constraint.
+		if( subject.type() == Symbol::Invalid )
+		{
+			if( tag.marker.type() == Symbol::Slack )
+			{
+				if( !addWithDualSimplex( rowptr, tag.marker ) )
+					throw UnsatisfiableConstraint( constraint );
+			}
+			else if( !addWithArtificialVariable( *rowptr ) )
+				throw UnsatisfiableConstraint( constraint );
+		}
+		else
+		{
+			// A fresh subject only needs to be substituted in the
+			// objective. This turns the insertion of constraints which
+			// extend an acyclic layout (a chain of boxes, a list) into a
+			// direct propagation of the new variable, without a pass over
+			// the tableau.
+			rowptr->solveFor( subject );
+			if( subject.id() >= fresh_tick )
+				m_objective->substitute( subject, *rowptr );
+			else
+				substitute( subject, *rowptr );
+			m_rows[ subject ] = rowptr.release();
+		}
+
+		m_cns[ constraint ] = tag;
+	}
+
+	/* Remove a constraint and its rows from the tableau.
+
+	The tableau is left primal feasible, but the objective is left to the
+	caller to optimize.
+
+	*/
+	void eraseConstraint( CnMap::iterator cn_it )
+	{
+		Constraint constraint( cn_it->first );
+		Tag tag( cn_it->second );
+		m_cns.erase( cn_it );
+
+		// Remove the error effects from the objective function
+		// *before* pivoting, or substitutions into the objective
+		// will lead to incorrect solver results.
+		removeConstraintEffects( constraint, tag );
+		removeMarkerRow( tag.marker );
+	}
+
+	/* Remove the row of a constraint marker from the tableau.
+
+	If the marker is basic, simply drop the row. Otherwise, pivot the
+	marker into the basis and then drop the row.
+
+	*/
+	void removeMarkerRow( const Symbol& marker )
+	{
+		auto row_it = m_rows.find( marker );
+		if( row_it != m_rows.end() )
+		{
+			std::unique_ptr<Row> rowptr( row_it->second );
+			m_rows.erase( row_it );
+		}
+		else
+		{
+			row_it = getMarkerLeavingRow( marker );
+			if( row_it == m_rows.end() )
+				throw InternalSolverError( "failed to find leaving row" );
+			Symbol leaving( row_it->first );
+			std::unique_ptr<Row> rowptr( row_it->second );
+			m_rows.erase( row_it );
+			rowptr->solveFor( leaving, marker );
+			substitute( marker, *rowptr );
+		}
+	}
+
  	/* Add the row to the tableau using an artificial variable.
 
 	This will return false if the constraint cannot be satisfied.
@@ -536,18 +1683,85 @@ private:
 	*/
 	void substitute( const Symbol& symbol, const Row& row )
 	{
-		for( auto& rowPair : m_rows )
+		if( useThreadPool() )
+			parallelSubstitute( symbol, row );
+		else
 		{
-			rowPair.second->substitute( symbol, row );
-			if( rowPair.first.type() != Symbol::External &&
-				rowPair.second->constant() < 0.0 )
-				m_infeasible_rows.push_back( rowPair.first );
+			substituteRows( m_rows.begin(), m_rows.end(), symbol, row,
+				[this]( RowMap::iterator it ) {
+					m_infeasible_rows.push( it->first, it->second->constant() );
+				} );
 		}
 		m_objective->substitute( symbol, row );
 		if( m_artificial.get() )
 			m_artificial->substitute( symbol, row );
 	}
 
+	/* Substitute the parametric symbol in a range of tableau rows.
+
+	The rows which become infeasible are passed to `infeasible`.
+
+	*/
+	template<typename Callback>
+	static void substituteRows( RowMap::iterator first,
+								RowMap::iterator last,
+								const Symbol& symbol,
+								const Row& row,
+								const Callback& infeasible )
+	{
+		for( ; first != last; ++first )
+		{
+			first->second->substitute( symbol, row );
+			if( first->first.type() != Symbol::External &&
+				first->second->constant() < 0.0 )
+				infeasible( first );
+		}
+	}
+
+	/* Substitute the parametric symbol in the tableau using the pool.
+
+	Each chunk of rows collects its infeasible rows in its own buffer.
+	The buffers are pushed onto the infeasible queue once all chunks are
+	done, since the queue itself is not thread safe.
+
+	*/
+	void parallelSubstitute( const Symbol& symbol, const Row& row )
+	{
+		const std::size_t count = m_rows.size();
+		ThreadPool& pool = ThreadPool::shared();
+		const std::size_t chunks = pool.size() * chunks_per_thread;
+		const std::size_t step = ( count + chunks - 1 ) / chunks;
+		const RowMap::iterator begin = m_rows.begin();
+		m_chunk_infeasible.resize( chunks );
+		pool.run( chunks, [&]( std::size_t chunk ) {
+			std::vector<RowMap::iterator>& infeasible( m_chunk_infeasible[ chunk ] );
+			infeasible.clear();
+			std::size_t first = std::min( count, chunk * step );
+			std::size_t last = std::min( count, first + step );
+			substituteRows( begin + first, begin + last, symbol, row,
+				[&infeasible]( RowMap::iterator it ) { infeasible.push_back( it ); } );
+		} );
+		for( const auto& infeasible : m_chunk_infeasible )
+		{
+			for( const auto& it : infeasible )
+				m_infeasible_rows.push( it->first, it->second->constant() );
+		}
+	}
+
+	/* Test whether the per-row work of a pivot should use the pool.
+
+	The shared pool is created the first time a tableau grows past the
+	parallel threshold. On a single core machine this always returns
+	false.
+
+	*/
+	bool useThreadPool() const
+	{
+		if( m_parallel_threshold == 0 || m_rows.size() < m_parallel_threshold )
+			return false;
+		return ThreadPool::shared().size() > 1;
+	}
+
 	/* Optimize the system for the given objective function.
 
 	This method performs iterations of Phase 2 of the simplex method
@@ -561,6 +1775,7 @@ private:
 	*/
 	void optimize( const Row& objective )
 	{
+		PivotUnlock unlock( m_pivot_lock );
 		while( true )
 		{
 			Symbol entering( getEnteringSymbol( objective ) );
@@ -576,6 +1791,7 @@ private:
 			row->solveFor( leaving, entering );
 			substitute( entering, *row );
 			m_rows[ entering ] = row;
+			++m_pivots;
 		}
 	}
 
@@ -586,6 +1802,11 @@ private:
 	an iteration of the dual simplex method to make the solution both
 	optimal and feasible.
 
+	The most infeasible row, i.e. the one with the most negative constant,
+	is made to leave the basis first. Rows are queued at most once, so a
+	row which is made infeasible by several pivots is only visited again
+	if it is still infeasible when it reaches the front of the queue.
+
 	Throws
 	------
 	InternalSolverError
@@ -594,15 +1815,38 @@ private:
 	*/
 	void dualOptimize()
 	{
-		while( !m_infeasible_rows.empty() )
-		{
+		dualOptimize( nullptr, nullptr );
+	}
 
-			Symbol leaving( m_infeasible_rows.back() );
-			m_infeasible_rows.pop_back();
+	/* Optimize the system using the dual simplex within a budget.
+
+	If `trail` is not null, the (leaving, entering) pair of every pivot
+	is appended to it, so that the pivots can be undone in reverse order.
+
+	If `budget` is not null, the method returns false once the budget is
+	exhausted. Every pivot keeps the objective optimal, so the tableau is
+	left dual feasible, with the rows which are still infeasible in the
+	queue for a later call.
+
+	*/
+	bool dualOptimize( std::vector<std::pair<Symbol, Symbol>>* trail, const Budget* budget )
+	{
+		PivotUnlock unlock( m_pivot_lock );
+		Symbol leaving;
+		std::size_t pivots = 0;
+		while( m_infeasible_rows.pop( leaving ) )
+		{
 			auto it = m_rows.find( leaving );
 			if( it != m_rows.end() && !nearZero( it->second->constant() ) &&
 				it->second->constant() < 0.0 )
 			{
+				if( budget && budget->exhausted( pivots ) )
+				{
+					m_infeasible_rows.push( leaving, it->second->constant() );
+					m_solve_pending = true;
+					return false;
+				}
+				++pivots;
 				Symbol entering( getDualEnteringSymbol( *it->second ) );
 				if( entering.type() == Symbol::Invalid )
 					throw InternalSolverError( "Dual optimize failed." );
@@ -612,8 +1856,14 @@ private:
 				row->solveFor( leaving, entering );
 				substitute( entering, *row );
 				m_rows[ entering ] = row;
+				++m_dual_pivots;
+				basisChanged();
+				if( trail )
+					trail->push_back( std::make_pair( leaving, entering ) );
 			}
 		}
+		m_solve_pending = false;
+		return true;
 	}
 
 	/* Compute the entering variable for a pivot operation.
@@ -689,10 +1939,40 @@ private:
 	*/
 	RowMap::iterator getLeavingRow( const Symbol& entering )
 	{
-		double ratio = std::numeric_limits<double>::max();
-		auto end = m_rows.end();
-		auto found = m_rows.end();
-		for( auto it = m_rows.begin(); it != end; ++it )
+		if( useThreadPool() )
+			return parallelLeavingRow( entering );
+		LeavingCandidate best( m_rows.end() );
+		scanLeavingRow( m_rows.begin(), m_rows.end(), entering, best );
+		return best.row;
+	}
+
+	/* Test whether a leaving row candidate improves on the current best.
+
+	The candidate must have a strictly smaller ratio, or, when the fill-in
+	heuristic is enabled, an equal ratio and a shorter row. Substituting
+	a shorter row creates fewer new cells in the rows which contain the
+	entering symbol.
+
+	*/
+	bool betterLeavingRow( double ratio, std::size_t length, const LeavingCandidate& best ) const
+	{
+		if( ratio < best.ratio )
+			return true;
+		return m_minimize_fill_in && ratio == best.ratio && length < best.length;
+	}
+
+	/* Run the ratio test of getLeavingRow over a range of rows.
+
+	The best row of the range is recorded in `best` if it improves on
+	the row already held there.
+
+	*/
+	void scanLeavingRow( RowMap::iterator first,
+						 RowMap::iterator last,
+						 const Symbol& entering,
+						 LeavingCandidate& best ) const
+	{
+		for( auto it = first; it != last; ++it )
 		{
 			if( it->first.type() != Symbol::External )
 			{
@@ -700,15 +1980,47 @@ private:
 				if( temp < 0.0 )
 				{
 					double temp_ratio = -it->second->constant() / temp;
-					if( temp_ratio < ratio )
+					std::size_t length = it->second->cells().size();
+					if( betterLeavingRow( temp_ratio, length, best ) )
 					{
-						ratio = temp_ratio;
-						found = it;
+						best.row = it;
+						best.ratio = temp_ratio;
+						best.length = length;
 					}
 				}
 			}
 		}
-		return found;
+	}
+
+	/* Run the ratio test of getLeavingRow using the pool.
+
+	The per-chunk bests are reduced in chunk order with the same
+	comparison as the sequential scan, so ties resolve to the same row.
+
+	*/
+	RowMap::iterator parallelLeavingRow( const Symbol& entering )
+	{
+		const std::size_t count = m_rows.size();
+		ThreadPool& pool = ThreadPool::shared();
+		const std::size_t chunks = pool.size() * chunks_per_thread;
+		const std::size_t step = ( count + chunks - 1 ) / chunks;
+		const RowMap::iterator begin = m_rows.begin();
+		const RowMap::iterator end = m_rows.end();
+		m_chunk_leaving.assign( chunks, LeavingCandidate( end ) );
+		pool.run( chunks, [&]( std::size_t chunk ) {
+			std::size_t first = std::min( count, chunk * step );
+			std::size_t last = std::min( count, first + step );
+			scanLeavingRow(
+				begin + first, begin + last, entering, m_chunk_leaving[ chunk ] );
+		} );
+		LeavingCandidate best( end );
+		for( const auto& candidate : m_chunk_leaving )
+		{
+			if( candidate.row != end &&
+				betterLeavingRow( candidate.ratio, candidate.length, best ) )
+				best = candidate;
+		}
+		return best.row;
 	}
 
 	/* Compute the leaving row for a marker variable.
@@ -814,10 +2126,29 @@ private:
 	RowMap m_rows;
 	VarMap m_vars;
 	EditMap m_edits;
-	std::vector<Symbol> m_infeasible_rows;
+	InfeasibleQueue m_infeasible_rows;
 	std::unique_ptr<Row> m_objective;
 	std::unique_ptr<Row> m_artificial;
 	Symbol::Id m_id_tick;
+	std::size_t m_pivots;
+	std::size_t m_dual_pivots;
+	std::size_t m_refactor_pivots;
+	std::size_t m_auto_refactor;
+	std::size_t m_parallel_threshold;
+	bool m_minimize_fill_in;
+	PivotLock* m_pivot_lock;
+	std::vector<std::vector<RowMap::iterator>> m_chunk_infeasible;
+	std::vector<LeavingCandidate> m_chunk_leaving;
+	std::size_t m_basis_epoch;
+	std::size_t m_suggest_tick;
+	std::size_t m_values_epoch;
+	std::vector<std::pair<Variable, const Row*>> m_value_rows;
+	MapType<Variable, double> m_deferred;
+	SolutionCache m_solution_cache;
+	bool m_reinstall_basis;
+	std::size_t m_cache_hits;
+	std::size_t m_cache_misses;
+	bool m_solve_pending;
 };
 
 } // namespace impl
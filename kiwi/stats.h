@@ -0,0 +1,53 @@
+/*-----------------------------------------------------------------------------
+| Copyright (c) 2013-2026, Nucleic Development Team.
+|
+| Distributed under the terms of the Modified BSD License.
+|
+| The full license is in the file LICENSE, distributed with this software.
+|----------------------------------------------------------------------------*/
+#pragma once
+#include <cstddef>
+
+namespace kiwi
+{
+
+/* A summary of the shape of the solver tableau and of the work done.
+
+The pivot counters are cumulative since the solver was created or last
+reset.
+
+*/
+struct SolverStats
+{
+    // The number of rows, i.e. of basic symbols, in the tableau.
+    std::size_t rows = 0;
+
+    // The number of non-zero cells over all the rows.
+    std::size_t cells = 0;
+
+    // The number of distinct parametric symbols used by the rows.
+    std::size_t columns = 0;
+
+    // The number of primal simplex pivots.
+    std::size_t pivots = 0;
+
+    // The number of dual simplex pivots, made while re-establishing
+    // feasibility after a suggested value.
+    std::size_t dualPivots = 0;
+
+    // The number of updates served and missed by the solution cache.
+    std::size_t cacheHits = 0;
+    std::size_t cacheMisses = 0;
+
+    /* The fraction of the rows x columns matrix which is non-zero.
+
+    */
+    double density() const
+    {
+        if (rows == 0 || columns == 0)
+            return 0.0;
+        return static_cast<double>(cells) / (static_cast<double>(rows) * columns);
+    }
+};
+
+} // namespace kiwi
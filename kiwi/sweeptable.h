@@ -0,0 +1,147 @@
+/*-----------------------------------------------------------------------------
+| Copyright (c) 2013-2026, Nucleic Development Team.
+|
+| Distributed under the terms of the Modified BSD License.
+|
+| The full license is in the file LICENSE, distributed with this software.
+|----------------------------------------------------------------------------*/
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "variable.h"
+
+namespace kiwi
+{
+
+/* The values of the solver variables over a range of suggested values.
+
+Within an optimal basis every variable is an affine function of the
+suggested value of an edit variable, so over a range the solution is
+piecewise linear. The table holds the breakpoints, and for each piece
+the values of the variables at its start and their slopes. Evaluating
+the solution for a suggested value in the range is a binary search and
+an affine evaluation, with no solver involvement.
+
+A table without pieces, such as a default constructed one, evaluates
+every variable to 0 and leaves the variables untouched when applied.
+
+*/
+class SweepTable
+{
+
+public:
+    SweepTable() : m_breakpoints(1, 0.0) {}
+
+    SweepTable(std::vector<Variable> variables, double lower) : m_variables(std::move(variables)),
+                                                               m_breakpoints(1, lower) {}
+
+    // The variables of the solver, in the order used by evaluate.
+    const std::vector<Variable> &variables() const
+    {
+        return m_variables;
+    }
+
+    // The start of every piece, followed by the end of the last one.
+    const std::vector<double> &breakpoints() const
+    {
+        return m_breakpoints;
+    }
+
+    double lower() const
+    {
+        return m_breakpoints.front();
+    }
+
+    double upper() const
+    {
+        return m_breakpoints.back();
+    }
+
+    std::size_t pieces() const
+    {
+        return m_breakpoints.size() - 1;
+    }
+
+    /* Compute the value of the variable at the given index.
+
+    The suggested value is clamped to the range of the table.
+
+    */
+    double value(std::size_t index, double suggested) const
+    {
+        if (pieces() == 0)
+            return 0.0;
+        std::size_t piece = findPiece(suggested);
+        std::size_t offset = piece * m_variables.size() + index;
+        return m_values[offset] + m_slopes[offset] * (clamp(suggested) - m_breakpoints[piece]);
+    }
+
+    /* Compute the values of all the variables.
+
+    */
+    void evaluate(double suggested, std::vector<double> &values) const
+    {
+        if (pieces() == 0)
+        {
+            values.assign(m_variables.size(), 0.0);
+            return;
+        }
+        std::size_t piece = findPiece(suggested);
+        std::size_t offset = piece * m_variables.size();
+        double delta = clamp(suggested) - m_breakpoints[piece];
+        values.resize(m_variables.size());
+        for (std::size_t i = 0; i < m_variables.size(); ++i)
+            values[i] = m_values[offset + i] + m_slopes[offset + i] * delta;
+    }
+
+    /* Set the values of the variables, as updateVariables would do.
+
+    */
+    void apply(double suggested) const
+    {
+        if (pieces() == 0)
+            return;
+        std::size_t piece = findPiece(suggested);
+        std::size_t offset = piece * m_variables.size();
+        double delta = clamp(suggested) - m_breakpoints[piece];
+        for (std::size_t i = 0; i < m_variables.size(); ++i)
+        {
+            Variable var(m_variables[i]);
+            var.setValue(m_values[offset + i] + m_slopes[offset + i] * delta);
+        }
+    }
+
+    /* Close the current piece at `end`, given the values of the
+    variables and their slopes over it, in the order of variables().
+
+    */
+    void addPiece(double end, const std::vector<double> &values, const std::vector<double> &slopes)
+    {
+        m_breakpoints.push_back(end);
+        m_values.insert(m_values.end(), values.begin(), values.end());
+        m_slopes.insert(m_slopes.end(), slopes.begin(), slopes.end());
+    }
+
+private:
+    double clamp(double suggested) const
+    {
+        return std::min(std::max(suggested, lower()), upper());
+    }
+
+    std::size_t findPiece(double suggested) const
+    {
+        if (m_breakpoints.size() < 3)
+            return 0;
+        auto it = std::upper_bound(m_breakpoints.begin() + 1, m_breakpoints.end() - 1, suggested);
+        return static_cast<std::size_t>(it - m_breakpoints.begin()) - 1;
+    }
+
+    std::vector<Variable> m_variables;
+    std::vector<double> m_breakpoints;
+    std::vector<double> m_values;
+    std::vector<double> m_slopes;
+};
+
+} // namespace kiwi
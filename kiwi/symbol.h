@@ -30,35 +30,39 @@ public:
 		Dummy
 	};
 
-	Symbol() : m_id( 0 ), m_type( Invalid ) {}
+	Symbol() : m_data( Invalid ) {}
 
-	Symbol( Type type, Id id ) : m_id( id ), m_type( type ) {}
+	Symbol( Type type, Id id ) : m_data( ( id << type_bits ) | type ) {}
 
 	~Symbol() = default;
 
 	Id id() const
 	{
-		return m_id;
+		return m_data >> type_bits;
 	}
 
 	Type type() const
 	{
-		return m_type;
+		return static_cast<Type>( m_data & type_mask );
 	}
 
 private:
 
-	Id m_id;
-	Type m_type;
+	// The type is packed in the low bits of the id, which halves the size
+	// of the tableau cells. Ordering the packed values orders the ids.
+	static const unsigned type_bits = 3;
+	static const Id type_mask = ( Id( 1 ) << type_bits ) - 1;
+
+	Id m_data;
 
 	friend bool operator<( const Symbol& lhs, const Symbol& rhs )
 	{
-		return lhs.m_id < rhs.m_id;
+		return lhs.m_data < rhs.m_data;
 	}
 
 	friend bool operator==( const Symbol& lhs, const Symbol& rhs )
 	{
-		return lhs.m_id == rhs.m_id;
+		return lhs.m_data == rhs.m_data;
 	}
 
 };
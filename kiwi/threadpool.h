@@ -0,0 +1,209 @@
+/*-----------------------------------------------------------------------------
+| Copyright (c) 2013-2026, Nucleic Development Team.
+|
+| Distributed under the terms of the Modified BSD License.
+|
+| The full license is in the file LICENSE, distributed with this software.
+|----------------------------------------------------------------------------*/
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace kiwi
+{
+
+namespace impl
+{
+
+/*
+Implementation note
+===================
+The pool is used by the solver to split the per-row work of a pivot over
+several threads. The workers are persistent so that the cost of a parallel
+pivot is a wake-up rather than a thread creation. The calling thread takes
+part in the work, so a pool of size N spawns N - 1 workers.
+
+All the solvers of a process share a single pool, of at most `max_size`
+threads, so that creating many large solvers does not multiply the number
+of threads. A run is executed on the calling thread alone while another
+run holds the pool, which also makes a run from within a task safe.
+*/
+class ThreadPool
+{
+
+public:
+
+	static const std::size_t max_size = 8;
+
+	explicit ThreadPool( std::size_t size ) :
+		m_task( nullptr ), m_count( 0 ), m_next( 0 ), m_done( 0 ),
+		m_active( 0 ), m_generation( 0 ), m_stop( false )
+	{
+		for( std::size_t i = 1; i < size; ++i )
+			m_workers.emplace_back( &ThreadPool::work, this );
+	}
+
+	ThreadPool( const ThreadPool& ) = delete;
+
+	ThreadPool& operator=( const ThreadPool& ) = delete;
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		for( auto& worker : m_workers )
+			worker.join();
+	}
+
+	/* The pool shared by the solvers of the process.
+
+	The pool is created on first use, with one thread per core up to
+	`max_size`. It is never destroyed: joining its workers from a static
+	destructor can deadlock while a shared library is being unloaded,
+	and idle workers are simply stopped with the process.
+
+	*/
+	static ThreadPool& shared()
+	{
+		static ThreadPool* pool = new ThreadPool( sharedSize() );
+		return *pool;
+	}
+
+	/* The number of threads taking part in a run, caller included.
+
+	*/
+	std::size_t size() const
+	{
+		return m_workers.size() + 1;
+	}
+
+	/* Run task( i ) for every i in [0, count) and wait for completion.
+
+	The indices are handed out dynamically, so the order of execution
+	is unspecified. If a task throws, the remaining indices are still run
+	and the first exception is rethrown on the calling thread.
+
+	*/
+	void run( std::size_t count, const std::function<void( std::size_t )>& task )
+	{
+		if( count == 0 )
+			return;
+		std::unique_lock<std::mutex> busy( m_run, std::try_to_lock );
+		if( !busy.owns_lock() )
+		{
+			for( std::size_t i = 0; i < count; ++i )
+				task( i );
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			m_task = &task;
+			m_count = count;
+			m_next.store( 0, std::memory_order_relaxed );
+			m_done.store( 0, std::memory_order_relaxed );
+			++m_generation;
+		}
+		m_wake.notify_all();
+
+		execute( task, count );
+
+		// Wait for the tasks to complete *and* for every worker which
+		// joined this run to leave it, so that a late worker can never
+		// pick up an index of the next run with a stale task.
+		std::unique_lock<std::mutex> lock( m_mutex );
+		m_finished.wait( lock, [this, count] {
+			return m_active == 0 &&
+				m_done.load( std::memory_order_acquire ) == count;
+		} );
+		m_task = nullptr;
+		if( m_error )
+		{
+			std::exception_ptr error = m_error;
+			m_error = nullptr;
+			std::rethrow_exception( error );
+		}
+	}
+
+private:
+
+	static std::size_t sharedSize()
+	{
+		std::size_t size = std::thread::hardware_concurrency();
+		return size < max_size ? size : max_size;
+	}
+
+	void execute( const std::function<void( std::size_t )>& task, std::size_t count )
+	{
+		std::size_t completed = 0;
+		while( true )
+		{
+			std::size_t index = m_next.fetch_add( 1, std::memory_order_relaxed );
+			if( index >= count )
+				break;
+			try
+			{
+				task( index );
+			}
+			catch( ... )
+			{
+				std::lock_guard<std::mutex> lock( m_mutex );
+				if( !m_error )
+					m_error = std::current_exception();
+			}
+			++completed;
+		}
+		if( completed )
+			m_done.fetch_add( completed, std::memory_order_acq_rel );
+	}
+
+	void work()
+	{
+		unsigned long long seen = 0;
+		std::unique_lock<std::mutex> lock( m_mutex );
+		while( true )
+		{
+			m_wake.wait( lock, [this, seen] {
+				return m_stop || ( m_task && m_generation != seen );
+			} );
+			if( m_stop )
+				return;
+			seen = m_generation;
+			const std::function<void( std::size_t )>* task = m_task;
+			std::size_t count = m_count;
+			++m_active;
+			lock.unlock();
+			execute( *task, count );
+			lock.lock();
+			--m_active;
+			m_finished.notify_all();
+		}
+	}
+
+	std::vector<std::thread> m_workers;
+	std::mutex m_run;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_finished;
+	const std::function<void( std::size_t )>* m_task;
+	std::size_t m_count;
+	std::atomic<std::size_t> m_next;
+	std::atomic<std::size_t> m_done;
+	std::size_t m_active;
+	unsigned long long m_generation;
+	std::exception_ptr m_error;
+	bool m_stop;
+};
+
+} // namespace impl
+
+} // namespace kiwi
@@ -0,0 +1,145 @@
+/*-----------------------------------------------------------------------------
+| Copyright (c) 2013-2026, Nucleic Development Team.
+|
+| Distributed under the terms of the Modified BSD License.
+|
+| The full license is in the file LICENSE, distributed with this software.
+|----------------------------------------------------------------------------*/
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "variable.h"
+
+
+namespace kiwi
+{
+
+/*
+Implementation note
+===================
+The values are published in two buffers used in turn: version v is
+written to buffer v % 2. A reader loads the version, copies its buffer,
+and checks that the writer has not started on version v + 2, which is
+the next one to reuse that buffer. The writer announces a version before
+writing it, so a reader only retries when it is overtaken by two
+publications, and the writer never waits for the readers. The buffers
+hold atomics so that a torn copy is detected rather than undefined.
+*/
+class ValueSnapshot
+{
+
+public:
+
+	using Version = std::uint64_t;
+
+	/* Create a snapshot of the given variables.
+
+	The index of a variable in the vector is its slot. The current values
+	are published as version zero.
+
+	*/
+	explicit ValueSnapshot( std::vector<Variable> variables ) :
+		m_variables( std::move( variables ) ),
+		m_version( 0 ),
+		m_begun( 0 )
+	{
+		for( auto& buffer : m_buffers )
+			buffer.reset( new std::atomic<double>[ m_variables.size() ] );
+		for( std::size_t i = 0; i < m_variables.size(); ++i )
+			m_buffers[ 0 ][ i ].store( m_variables[ i ].value(), std::memory_order_relaxed );
+	}
+
+	ValueSnapshot( const ValueSnapshot& ) = delete;
+
+	ValueSnapshot& operator=( const ValueSnapshot& ) = delete;
+
+	std::size_t size() const
+	{
+		return m_variables.size();
+	}
+
+	/* The slot of the variable, or size() if it is not in the snapshot.
+
+	*/
+	std::size_t slot( const Variable& variable ) const
+	{
+		for( std::size_t i = 0; i < m_variables.size(); ++i )
+		{
+			if( m_variables[ i ].equals( variable ) )
+				return i;
+		}
+		return m_variables.size();
+	}
+
+	/* Publish the current values of the variables as a new version.
+
+	This must be called from a single thread, the one which updates the
+	variables, for example from the callback of an AsyncSolver.
+
+	*/
+	Version publish()
+	{
+		Version next = m_version.load( std::memory_order_relaxed ) + 1;
+		m_begun.store( next, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_release );
+		std::atomic<double>* buffer = m_buffers[ next % 2 ].get();
+		for( std::size_t i = 0; i < m_variables.size(); ++i )
+			buffer[ i ].store( m_variables[ i ].value(), std::memory_order_relaxed );
+		m_version.store( next, std::memory_order_release );
+		return next;
+	}
+
+	/* The last published version.
+
+	*/
+	Version version() const
+	{
+		return m_version.load( std::memory_order_acquire );
+	}
+
+	/* Copy the values of the last published version, indexed by slot.
+
+	The values all come from the returned version. This may be called
+	from any thread and does not block.
+
+	*/
+	Version read( std::vector<double>& values ) const
+	{
+		values.resize( m_variables.size() );
+		while( true )
+		{
+			Version version = m_version.load( std::memory_order_acquire );
+			const std::atomic<double>* buffer = m_buffers[ version % 2 ].get();
+			for( std::size_t i = 0; i < values.size(); ++i )
+				values[ i ] = buffer[ i ].load( std::memory_order_relaxed );
+			std::atomic_thread_fence( std::memory_order_acquire );
+			if( m_begun.load( std::memory_order_relaxed ) <= version + 1 )
+				return version;
+		}
+	}
+
+	/* The value of the variable at the slot.
+
+	The value is from the last published version or from one being
+	published. Use read() for values which are consistent with each other.
+
+	*/
+	double value( std::size_t slot ) const
+	{
+		Version version = m_version.load( std::memory_order_acquire );
+		return m_buffers[ version % 2 ][ slot ].load( std::memory_order_relaxed );
+	}
+
+private:
+
+	std::vector<Variable> m_variables;
+	std::unique_ptr<std::atomic<double>[]> m_buffers[ 2 ];
+	std::atomic<Version> m_version;
+	std::atomic<Version> m_begun;
+};
+
+} // namespace kiwi
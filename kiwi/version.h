@@ -8,7 +8,11 @@
 #pragma once
 
 #define KIWI_MAJOR_VERSION 1
-#define KIWI_MINOR_VERSION 4
-#define KIWI_MICRO_VERSION 2
-#define KIWI_VERSION_HEX 0x010402
-#define KIWI_VERSION "1.4.2"
+#define KIWI_MINOR_VERSION 5
+#define KIWI_MICRO_VERSION 0
+#define KIWI_VERSION_HEX 0x010500
+#define KIWI_VERSION "1.5.0"
+
+// Bumped whenever the layout of the kiwi classes changes, since the solver
+// objects are shared with other extensions through the kiwisolver C API.
+#define KIWI_ABI_VERSION 1
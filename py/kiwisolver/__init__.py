@@ -5,9 +5,12 @@
 #
 # The full license is in the file LICENSE, distributed with this software.
 # --------------------------------------------------------------------------------------
+import os
+
 from ._cext import (
     Constraint,
     Expression,
+    LinearExpression,
     Solver,
     Term,
     Variable,
@@ -30,6 +33,7 @@ __all__ = [
     "DuplicateConstraint",
     "DuplicateEditVariable",
     "Expression",
+    "LinearExpression",
     "Solver",
     "Term",
     "UnknownConstraint",
@@ -38,5 +42,16 @@ __all__ = [
     "Variable",
     "__kiwi_version__",
     "__version__",
+    "get_include",
     "strength",
 ]
+
+
+def get_include() -> str:
+    """Get the directory of the headers of the C API.
+
+    The directory holds kiwisolver/capi.h, and in an installed package the
+    kiwi headers kiwisolver was built with, under kiwi/.
+
+    """
+    return os.path.join(os.path.dirname(__file__), "include")
@@ -6,13 +6,25 @@
 # The full license is in the file LICENSE, distributed with this software.
 # --------------------------------------------------------------------------------------
 
-from typing import Any, Iterable, NoReturn, Tuple, type_check_only
+from typing import (
+    Any,
+    Iterable,
+    List,
+    NoReturn,
+    Sequence,
+    Tuple,
+    TypeVar,
+    overload,
+    type_check_only,
+)
 
 try:
     from typing import Literal
 except ImportError:
     from typing_extensions import Literal  # type: ignore
 
+_Buffer = TypeVar("_Buffer")
+
 __version__: str
 __kiwi_version__: str
 
@@ -139,6 +151,59 @@ class Expression:
     def __gt__(self, other: Any) -> NoReturn: ...
     def __lt__(self, other: Any) -> NoReturn: ...
 
+class LinearExpression:
+    """Mutable sum of terms, built in place.
+
+    Adding to the expression with +=, -=, addTerm or addTerms appends to it
+    without creating intermediate objects, so long sums stay linear. The
+    terms are reduced when an Expression or a Constraint is made from it.
+
+    """
+
+    __hash__: None  # type: ignore
+    def __init__(self, constant: int | float = 0.0, /) -> None: ...
+    def addTerm(self, variable: Variable, coefficient: int | float = 1.0, /) -> None:
+        """Add a variable with a coefficient, by default 1, to the expression."""
+        ...
+    def addTerms(
+        self,
+        variables: Sequence[Variable],
+        coefficients: Sequence[int | float] | None = None,
+        /,
+    ) -> None:
+        """Add a sequence of variables with a sequence of coefficients to the expression."""
+        ...
+    def expression(self) -> Expression:
+        """Get the reduced Expression for the sum."""
+        ...
+    def value(self) -> float:
+        """Get the value for the expression."""
+        ...
+    def __iadd__(
+        self, other: float | Variable | Term | Expression | LinearExpression
+    ) -> LinearExpression: ...
+    def __isub__(
+        self, other: float | Variable | Term | Expression | LinearExpression
+    ) -> LinearExpression: ...
+    def __add__(
+        self, other: float | Variable | Term | Expression | LinearExpression
+    ) -> LinearExpression: ...
+    def __radd__(
+        self, other: float | Variable | Term | Expression
+    ) -> LinearExpression: ...
+    def __sub__(
+        self, other: float | Variable | Term | Expression | LinearExpression
+    ) -> LinearExpression: ...
+    def __rsub__(
+        self, other: float | Variable | Term | Expression
+    ) -> LinearExpression: ...
+    def __eq__(self, other: float | Variable | Term | Expression | LinearExpression) -> Constraint: ...  # type: ignore
+    def __ge__(self, other: float | Variable | Term | Expression | LinearExpression) -> Constraint: ...
+    def __le__(self, other: float | Variable | Term | Expression | LinearExpression) -> Constraint: ...
+    def __ne__(self, other: Any) -> NoReturn: ...
+    def __gt__(self, other: Any) -> NoReturn: ...
+    def __lt__(self, other: Any) -> NoReturn: ...
+
 class Constraint:
     def __init__(
         self,
@@ -187,9 +252,60 @@ class Solver:
     def addConstraint(self, constraint: Constraint, /) -> None:
         """Add a constraint to the solver."""
         ...
+    def addConstraints(self, constraints: Sequence[Constraint], /) -> None:
+        """Add a sequence of constraints to the solver.
+
+        The solver is locked once for the whole sequence. Either all the
+        constraints are added, or none, and the error carries the offending
+        constraint.
+
+        """
+        ...
+    def addLinearConstraints(
+        self,
+        variables: Sequence[Variable],
+        indptr: Any,
+        indices: Any,
+        data: Any,
+        rhs: Any,
+        op: Literal["=="]
+        | Literal["<="]
+        | Literal[">="]
+        | Sequence[Literal["=="] | Literal["<="] | Literal[">="]],
+        strength: float
+        | Literal["weak"]
+        | Literal["medium"]
+        | Literal["strong"]
+        | Literal["required"]
+        | Sequence[
+            float
+            | Literal["weak"]
+            | Literal["medium"]
+            | Literal["strong"]
+            | Literal["required"]
+        ] = "required",
+    ) -> List[Constraint]:
+        """Create and add the constraints of the rows of a sparse matrix.
+
+        Row i of the matrix in CSR form, given by the buffers indptr,
+        indices and data, yields the constraint
+        sum(data[k] * variables[indices[k]]) op[i] rhs[i]. The buffers hold
+        integers, or floats for data and rhs, as in a scipy csr_matrix. op
+        and strength are given for all the rows or for each row. The
+        constraints are added as by addConstraints and returned.
+
+        """
+        ...
     def removeConstraint(self, constraint: Constraint, /) -> None:
         """Remove a constraint from the solver."""
         ...
+    def removeConstraints(self, constraints: Sequence[Constraint], /) -> None:
+        """Remove a sequence of constraints from the solver.
+
+        Either all the constraints are removed, or none.
+
+        """
+        ...
     def hasConstraint(self, constraint: Constraint, /) -> bool:
         """Check whether the solver contains a constraint."""
         ...
@@ -205,6 +321,26 @@ class Solver:
     ) -> None:
         """Add an edit variable to the solver."""
         ...
+    def addEditVariables(
+        self,
+        edits: Sequence[
+            Tuple[
+                Variable,
+                float
+                | Literal["weak"]
+                | Literal["medium"]
+                | Literal["strong"]
+                | Literal["required"],
+            ]
+        ],
+        /,
+    ) -> None:
+        """Add edit variables to the solver with their strengths.
+
+        Either all the edit variables are added, or none.
+
+        """
+        ...
     def removeEditVariable(self, variable: Variable, /) -> None:
         """Remove an edit variable from the solver."""
         ...
@@ -214,9 +350,42 @@ class Solver:
     def suggestValue(self, variable: Variable, value: int | float, /) -> None:
         """Suggest a desired value for an edit variable."""
         ...
+    def suggestValues(
+        self,
+        suggestions: Sequence[Tuple[Variable, int | float]],
+        /,
+    ) -> None:
+        """Suggest desired values for several edit variables.
+
+        The dual optimization runs once for all the suggestions. No value is
+        suggested if one of the variables is not an edit variable.
+
+        """
+        ...
     def updateVariables(self) -> None:
         """Update the values of the solver variables."""
         ...
+    @overload
+    def values(self, variables: Sequence[Variable], /) -> List[float]: ...
+    @overload
+    def values(self, variables: Sequence[Variable], out: _Buffer, /) -> _Buffer:
+        """Read the values of the variables, as of the last update.
+
+        The values are returned as a list, or written in one pass to `out`,
+        a writable contiguous buffer of len(variables) doubles such as an
+        array("d") or a float64 numpy array, which is then returned.
+
+        """
+        ...
+    def setGilThreshold(self, rows: int, /) -> None:
+        """Set the number of tableau rows above which the GIL is released.
+
+        Operations on a solver whose tableau holds at least that many rows
+        let the other Python threads run while the solver pivots. Zero never
+        releases the GIL.
+
+        """
+        ...
     def reset(self) -> None:
         """Reset the solver to the initial empty starting condition."""
         ...
@@ -0,0 +1,68 @@
+# --------------------------------------------------------------------------------------
+# Copyright (c) 2013-2026, Nucleic Development Team.
+#
+# Distributed under the terms of the Modified BSD License.
+#
+# The full license is in the file LICENSE, distributed with this software.
+# --------------------------------------------------------------------------------------
+"""Awaitable solver operations for asyncio applications."""
+
+import asyncio
+from concurrent.futures import Executor
+from typing import Any, Callable, Literal, Optional, TypeVar
+
+from ._cext import Constraint, Solver, Variable
+
+T = TypeVar("T")
+
+
+class AsyncSolver:
+    """Run the operations of a solver in an executor.
+
+    The event loop keeps running while the solver works. Solvers whose
+    tableau holds more rows than their GIL threshold release the GIL,
+    so the other Python threads run concurrently as well.
+
+    """
+
+    def __init__(
+        self, solver: Optional[Solver] = None, executor: Optional[Executor] = None
+    ) -> None:
+        self.solver = solver if solver is not None else Solver()
+        self.executor = executor
+
+    async def _run(self, func: Callable[..., T], *args: Any) -> T:
+        loop = asyncio.get_running_loop()
+        return await loop.run_in_executor(self.executor, func, *args)
+
+    async def addConstraint(self, constraint: Constraint) -> None:
+        """Add a constraint to the solver."""
+        await self._run(self.solver.addConstraint, constraint)
+
+    async def removeConstraint(self, constraint: Constraint) -> None:
+        """Remove a constraint from the solver."""
+        await self._run(self.solver.removeConstraint, constraint)
+
+    async def addEditVariable(
+        self,
+        variable: Variable,
+        strength: float
+        | Literal["weak"]
+        | Literal["medium"]
+        | Literal["strong"]
+        | Literal["required"],
+    ) -> None:
+        """Add an edit variable to the solver."""
+        await self._run(self.solver.addEditVariable, variable, strength)
+
+    async def removeEditVariable(self, variable: Variable) -> None:
+        """Remove an edit variable from the solver."""
+        await self._run(self.solver.removeEditVariable, variable)
+
+    async def suggestValue(self, variable: Variable, value: float) -> None:
+        """Suggest a desired value for an edit variable."""
+        await self._run(self.solver.suggestValue, variable, value)
+
+    async def updateVariables(self) -> None:
+        """Update the values of the solver variables."""
+        await self._run(self.solver.updateVariables)
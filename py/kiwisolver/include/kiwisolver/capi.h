@@ -0,0 +1,186 @@
+/*-----------------------------------------------------------------------------
+| Copyright (c) 2026, Nucleic Development Team.
+|
+| Distributed under the terms of the Modified BSD License.
+|
+| The full license is in the file LICENSE, distributed with this software.
+|----------------------------------------------------------------------------*/
+#pragma once
+#include <Python.h>
+#include <cstddef>
+#include <cstring>
+#include <kiwi/kiwi.h>
+
+// The kiwi objects are shared with the extension, so they must have the
+// same layout, and the same kind of reference counts: atomic ones on
+// free-threaded builds, like kiwisolver itself, and plain ones otherwise.
+#if defined(Py_GIL_DISABLED) && !defined(KIWI_ATOMIC_REFCOUNT)
+#error "free-threaded extensions using the kiwisolver C API need KIWI_ATOMIC_REFCOUNT"
+#endif
+
+#if defined(KIWI_ATOMIC_REFCOUNT)
+#define KIWISOLVER_ATOMIC_REFCOUNT 1
+#else
+#define KIWISOLVER_ATOMIC_REFCOUNT 0
+#endif
+
+#if !defined(KIWI_ABI_VERSION)
+#error "the kiwi headers are older than the kiwisolver C API"
+#endif
+
+
+/* The C API of kiwisolver, for other extensions.
+
+The table is exported by the `kiwisolver._cext._C_API` capsule, and is
+loaded with `KiwiSolver_ImportCAPI`. Functions are only ever appended to
+the table, and the version is bumped when they are. The kiwi headers used
+to build the extension must be those of the installed kiwisolver. Their
+version, ABI version, the sizes of the shared kiwi classes and the kind
+of reference counts are checked on import.
+
+All the functions must be called with the GIL held.
+
+*/
+#define KIWISOLVER_CAPI_NAME "kiwisolver._cext._C_API"
+#define KIWISOLVER_CAPI_VERSION 1
+
+
+struct KiwiSolver_CAPI
+{
+	int version;
+
+	const char* kiwi_version;
+
+	int kiwi_abi_version;
+
+	std::size_t solver_size;
+
+	std::size_t symbol_size;
+
+	std::size_t shared_data_size;
+
+	int atomic_refcount;
+
+	PyTypeObject* VariableType;
+
+	PyTypeObject* ConstraintType;
+
+	PyTypeObject* SolverType;
+
+	/* Get the kiwi variable of a Variable.
+
+	Returns NULL with a TypeError if the object is not a Variable. The
+	pointer is valid while the object is alive.
+
+	*/
+	kiwi::Variable* ( *Variable_AsVariable )( PyObject* variable );
+
+	/* Get the kiwi constraint of a Constraint.
+
+	Returns NULL with a TypeError if the object is not a Constraint. The
+	pointer is valid while the object is alive.
+
+	*/
+	kiwi::Constraint* ( *Constraint_AsConstraint )( PyObject* constraint );
+
+	/* Lock a Solver and get its kiwi solver.
+
+	Returns NULL with a TypeError if the object is not a Solver. The lock
+	is waited for without the GIL. Until `Solver_Release` is called, the
+	kiwi solver may be used directly. Unless the reference counts are
+	atomic, the GIL must be held while doing so, but the solver can
+	release it during its pivots through a `kiwi::PivotLock`. The methods
+	of the Python solver and the functions below must not be called on
+	the locked solver.
+
+	*/
+	kiwi::Solver* ( *Solver_Acquire )( PyObject* solver );
+
+	/* Unlock a Solver locked by `Solver_Acquire`.
+
+	It must be called exactly once for each successful `Solver_Acquire`,
+	with the same object, from the thread which acquired it. An object
+	which is not a Solver is ignored.
+
+	*/
+	void ( *Solver_Release )( PyObject* solver );
+
+	/* Add several Constraints to a Solver.
+
+	Locks the solver like its methods do. Either all the constraints are
+	added, or none. Returns 0 on success, and -1 with a TypeError or a
+	kiwisolver exception for the offending constraint otherwise.
+
+	*/
+	int ( *Solver_AddConstraints )( PyObject* solver, PyObject* const* constraints, Py_ssize_t count );
+
+	/* Remove several Constraints from a Solver.
+
+	Either all the constraints are removed, or none. Returns 0 on success,
+	and -1 with an exception set otherwise.
+
+	*/
+	int ( *Solver_RemoveConstraints )( PyObject* solver, PyObject* const* constraints, Py_ssize_t count );
+
+	/* Suggest values for several edit Variables of a Solver.
+
+	The dual simplex runs once, after the last suggestion. Returns 0 on
+	success, and -1 with an exception set otherwise.
+
+	*/
+	int ( *Solver_SuggestValues )(
+		PyObject* solver, PyObject* const* variables, const double* values, Py_ssize_t count );
+
+	/* Update the values of the variables of a Solver.
+
+	Returns 0 on success, and -1 with a TypeError otherwise.
+
+	*/
+	int ( *Solver_UpdateVariables )( PyObject* solver );
+};
+
+
+/* Load the C API table of kiwisolver.
+
+Returns NULL with an ImportError if the table is older than the header,
+or if the extension was built with kiwi headers of another version or
+layout.
+
+*/
+static inline const KiwiSolver_CAPI*
+KiwiSolver_ImportCAPI()
+{
+	const KiwiSolver_CAPI* api = static_cast<const KiwiSolver_CAPI*>(
+		PyCapsule_Import( KIWISOLVER_CAPI_NAME, 0 ) );
+	if( !api )
+		return 0;
+	if( api->version < KIWISOLVER_CAPI_VERSION )
+	{
+		PyErr_Format(
+			PyExc_ImportError,
+			"kiwisolver C API version %d is older than %d",
+			api->version,
+			KIWISOLVER_CAPI_VERSION );
+		return 0;
+	}
+	if( std::strcmp( api->kiwi_version, KIWI_VERSION ) != 0 ||
+		api->kiwi_abi_version != KIWI_ABI_VERSION ||
+		api->solver_size != sizeof( kiwi::Solver ) ||
+		api->symbol_size != sizeof( kiwi::impl::Symbol ) ||
+		api->shared_data_size != sizeof( kiwi::SharedData ) ||
+		api->atomic_refcount != KIWISOLVER_ATOMIC_REFCOUNT )
+	{
+		PyErr_Format(
+			PyExc_ImportError,
+			"kiwisolver was built with kiwi %s (ABI %d%s), incompatible with "
+			"the kiwi %s (ABI %d%s) headers of this extension",
+			api->kiwi_version,
+			api->kiwi_abi_version,
+			api->atomic_refcount ? ", atomic" : "",
+			KIWI_VERSION,
+			KIWI_ABI_VERSION,
+			KIWISOLVER_ATOMIC_REFCOUNT ? ", atomic" : "" );
+		return 0;
+	}
+	return api;
+}
@@ -0,0 +1,253 @@
+/*-----------------------------------------------------------------------------
+| Copyright (c) 2026, Nucleic Development Team.
+|
+| Distributed under the terms of the Modified BSD License.
+|
+| The full license is in the file LICENSE, distributed with this software.
+|----------------------------------------------------------------------------*/
+#include <cppy/cppy.h>
+#include <cassert>
+#include <utility>
+#include <vector>
+#include <kiwi/kiwi.h>
+#include <kiwisolver/capi.h>
+#include "types.h"
+#include "util.h"
+
+
+namespace kiwisolver
+{
+
+namespace
+{
+
+Solver*
+as_solver( PyObject* solver )
+{
+	if( !Solver::TypeCheck( solver ) )
+	{
+		cppy::type_error( solver, "Solver" );
+		return 0;
+	}
+	return reinterpret_cast<Solver*>( solver );
+}
+
+
+bool
+collect_constraints( PyObject* const* items, Py_ssize_t count, std::vector<kiwi::Constraint>& out )
+{
+	out.reserve( count );
+	for( Py_ssize_t i = 0; i < count; ++i )
+	{
+		if( !Constraint::TypeCheck( items[ i ] ) )
+		{
+			cppy::type_error( items[ i ], "Constraint" );
+			return false;
+		}
+		out.push_back( reinterpret_cast<Constraint*>( items[ i ] )->constraint );
+	}
+	return true;
+}
+
+
+kiwi::Variable*
+CAPI_Variable_AsVariable( PyObject* variable )
+{
+	if( !Variable::TypeCheck( variable ) )
+	{
+		cppy::type_error( variable, "Variable" );
+		return 0;
+	}
+	return &reinterpret_cast<Variable*>( variable )->variable;
+}
+
+
+kiwi::Constraint*
+CAPI_Constraint_AsConstraint( PyObject* constraint )
+{
+	if( !Constraint::TypeCheck( constraint ) )
+	{
+		cppy::type_error( constraint, "Constraint" );
+		return 0;
+	}
+	return &reinterpret_cast<Constraint*>( constraint )->constraint;
+}
+
+
+kiwi::Solver*
+CAPI_Solver_Acquire( PyObject* solver )
+{
+	Solver* self = as_solver( solver );
+	if( !self )
+		return 0;
+	if( !self->mutex.try_lock() )
+	{
+		Py_BEGIN_ALLOW_THREADS
+		self->mutex.lock();
+		Py_END_ALLOW_THREADS
+	}
+	return &self->solver;
+}
+
+
+void
+CAPI_Solver_Release( PyObject* solver )
+{
+	// Acquire only succeeds for solvers, so anything else is a misuse. It
+	// is ignored, since the function cannot report an error.
+	assert( Solver::TypeCheck( solver ) );
+	if( Solver::TypeCheck( solver ) )
+		reinterpret_cast<Solver*>( solver )->mutex.unlock();
+}
+
+
+int
+CAPI_Solver_AddConstraints( PyObject* solver, PyObject* const* constraints, Py_ssize_t count )
+{
+	Solver* self = as_solver( solver );
+	std::vector<kiwi::Constraint> items;
+	if( !self || !collect_constraints( constraints, count, items ) )
+		return -1;
+	PyObject* error = 0;
+	Py_ssize_t index = 0;
+	{
+		SolverGuard guard( self );
+		try
+		{
+			self->solver.addConstraints( items );
+		}
+		catch( const kiwi::DuplicateConstraint& e )
+		{
+			error = DuplicateConstraint;
+			index = find_constraint( items, e.constraint() );
+			assert( index >= 0 );
+		}
+		catch( const kiwi::UnsatisfiableConstraint& e )
+		{
+			error = UnsatisfiableConstraint;
+			index = find_constraint( items, e.constraint() );
+			assert( index >= 0 );
+		}
+	}
+	if( error )
+	{
+		PyErr_SetObject( error, constraints[ index ] );
+		return -1;
+	}
+	return 0;
+}
+
+
+int
+CAPI_Solver_RemoveConstraints( PyObject* solver, PyObject* const* constraints, Py_ssize_t count )
+{
+	Solver* self = as_solver( solver );
+	std::vector<kiwi::Constraint> items;
+	if( !self || !collect_constraints( constraints, count, items ) )
+		return -1;
+	PyObject* error = 0;
+	Py_ssize_t index = 0;
+	{
+		SolverGuard guard( self );
+		try
+		{
+			self->solver.removeConstraints( items );
+		}
+		catch( const kiwi::UnknownConstraint& e )
+		{
+			error = UnknownConstraint;
+			index = find_constraint( items, e.constraint() );
+			assert( index >= 0 );
+		}
+	}
+	if( error )
+	{
+		PyErr_SetObject( error, constraints[ index ] );
+		return -1;
+	}
+	return 0;
+}
+
+
+int
+CAPI_Solver_SuggestValues(
+	PyObject* solver, PyObject* const* variables, const double* values, Py_ssize_t count )
+{
+	Solver* self = as_solver( solver );
+	if( !self )
+		return -1;
+	std::vector<std::pair<kiwi::Variable, double>> suggestions;
+	suggestions.reserve( count );
+	for( Py_ssize_t i = 0; i < count; ++i )
+	{
+		kiwi::Variable* variable = CAPI_Variable_AsVariable( variables[ i ] );
+		if( !variable )
+			return -1;
+		suggestions.push_back( std::make_pair( *variable, values[ i ] ) );
+	}
+	bool unknown = false;
+	Py_ssize_t index = 0;
+	{
+		SolverGuard guard( self );
+		try
+		{
+			self->solver.suggestValues( suggestions );
+		}
+		catch( const kiwi::UnknownEditVariable& e )
+		{
+			unknown = true;
+			index = find_variable( suggestions, e.variable() );
+			assert( index >= 0 );
+		}
+	}
+	if( unknown )
+	{
+		PyErr_SetObject( UnknownEditVariable, variables[ index ] );
+		return -1;
+	}
+	return 0;
+}
+
+
+int
+CAPI_Solver_UpdateVariables( PyObject* solver )
+{
+	Solver* self = as_solver( solver );
+	if( !self )
+		return -1;
+	SolverGuard guard( self );
+	self->solver.updateVariables();
+	return 0;
+}
+
+
+KiwiSolver_CAPI capi;
+
+} // namespace
+
+
+PyObject*
+new_capi_capsule()
+{
+	capi.version = KIWISOLVER_CAPI_VERSION;
+	capi.kiwi_version = KIWI_VERSION;
+	capi.kiwi_abi_version = KIWI_ABI_VERSION;
+	capi.solver_size = sizeof( kiwi::Solver );
+	capi.symbol_size = sizeof( kiwi::impl::Symbol );
+	capi.shared_data_size = sizeof( kiwi::SharedData );
+	capi.atomic_refcount = KIWISOLVER_ATOMIC_REFCOUNT;
+	capi.VariableType = Variable::TypeObject;
+	capi.ConstraintType = Constraint::TypeObject;
+	capi.SolverType = Solver::TypeObject;
+	capi.Variable_AsVariable = CAPI_Variable_AsVariable;
+	capi.Constraint_AsConstraint = CAPI_Constraint_AsConstraint;
+	capi.Solver_Acquire = CAPI_Solver_Acquire;
+	capi.Solver_Release = CAPI_Solver_Release;
+	capi.Solver_AddConstraints = CAPI_Solver_AddConstraints;
+	capi.Solver_RemoveConstraints = CAPI_Solver_RemoveConstraints;
+	capi.Solver_SuggestValues = CAPI_Solver_SuggestValues;
+	capi.Solver_UpdateVariables = CAPI_Solver_UpdateVariables;
+	return PyCapsule_New( &capi, KIWISOLVER_CAPI_NAME, 0 );
+}
+
+}  // namespace kiwisolver
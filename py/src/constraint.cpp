@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <sstream>
 #include <kiwi/kiwi.h>
+#include "freelist.h"
 #include "types.h"
 #include "util.h"
 
@@ -45,10 +46,8 @@ Constraint_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
     if (!cn->expression)
         return 0;
 
-    ACQUIRE_GLOBAL_LOCK();
     kiwi::Expression expr(convert_to_kiwi_expression(cn->expression));
     new (&cn->constraint) kiwi::Constraint(expr, op, strength);
-    RELEASE_GLOBAL_LOCK();
 
     return pycn.release();
 }
@@ -72,9 +71,7 @@ void Constraint_dealloc(Constraint *self)
 {
     PyObject_GC_UnTrack(self);
     Constraint_clear(self);
-    ACQUIRE_GLOBAL_LOCK();
     self->constraint.~Constraint();
-    RELEASE_GLOBAL_LOCK();
     Py_TYPE(self)->tp_free(pyobject_cast(self));
 }
 
@@ -83,25 +80,19 @@ Constraint_repr(Constraint *self)
 {
     std::stringstream stream;
     Expression *expr = reinterpret_cast<Expression *>(self->expression);
-    Py_ssize_t size = PyTuple_GET_SIZE(expr->terms);
+    Py_ssize_t size = Py_SIZE(expr);
     for (Py_ssize_t i = 0; i < size; ++i)
     {
-        PyObject *item = PyTuple_GET_ITEM(expr->terms, i);
-        Term *term = reinterpret_cast<Term *>(item);
-        stream << term->coefficient << " * ";
-        ACQUIRE_GLOBAL_LOCK();
-        std::string name = reinterpret_cast<Variable *>(term->variable)->variable.name();
-        RELEASE_GLOBAL_LOCK();
+        stream << expr->items[i].coefficient << " * ";
+        std::string name = variable_name(expr->items[i].variable);
         stream << name;
         stream << " + ";
     }
     stream << expr->constant;
 
-    ACQUIRE_GLOBAL_LOCK();
     kiwi::RelationalOperator op = self->constraint.op();
     double strength = self->constraint.strength();
     bool violated = self->constraint.violated();
-    RELEASE_GLOBAL_LOCK();
 
     switch (op)
     {
@@ -134,9 +125,7 @@ Constraint_op(Constraint *self)
 {
     PyObject *res = 0;
 
-    ACQUIRE_GLOBAL_LOCK();
     kiwi::RelationalOperator op = self->constraint.op();
-    RELEASE_GLOBAL_LOCK();
 
     switch (op)
     {
@@ -156,18 +145,14 @@ Constraint_op(Constraint *self)
 PyObject *
 Constraint_strength(Constraint *self)
 {
-    ACQUIRE_GLOBAL_LOCK();
     double strength = self->constraint.strength();
-    RELEASE_GLOBAL_LOCK();
     return PyFloat_FromDouble(strength);
 }
 
 PyObject *
 Constraint_violated(Constraint *self)
 {
-    ACQUIRE_GLOBAL_LOCK();
     bool violated = self->constraint.violated();
-    RELEASE_GLOBAL_LOCK();
 
     if (violated) {
         Py_RETURN_TRUE;
@@ -191,9 +176,7 @@ Constraint_or(PyObject *pyoldcn, PyObject *value)
     Constraint *newcn = reinterpret_cast<Constraint *>(pynewcn);
     newcn->expression = cppy::incref(oldcn->expression);
 
-    ACQUIRE_GLOBAL_LOCK();
     new (&newcn->constraint) kiwi::Constraint(oldcn->constraint, strength);
-    RELEASE_GLOBAL_LOCK();
 
     return pynewcn;
 }
@@ -219,8 +202,8 @@ static PyType_Slot Constraint_Type_slots[] = {
     {Py_tp_repr, void_cast(Constraint_repr)},         /* tp_repr */
     {Py_tp_methods, void_cast(Constraint_methods)},   /* tp_methods */
     {Py_tp_new, void_cast(Constraint_new)},           /* tp_new */
-    {Py_tp_alloc, void_cast(PyType_GenericAlloc)},    /* tp_alloc */
-    {Py_tp_free, void_cast(PyObject_GC_Del)},         /* tp_free */
+    {Py_tp_alloc, void_cast(FreeList<Constraint>::alloc)}, /* tp_alloc */
+    {Py_tp_free, void_cast(FreeList<Constraint>::free)},   /* tp_free */
     {Py_nb_or, void_cast(Constraint_or)},             /* nb_or */
     {0, 0},
 };
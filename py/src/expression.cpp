@@ -6,7 +6,10 @@
 | The full license is in the file LICENSE, distributed with this software.
 |----------------------------------------------------------------------------*/
 #include <cppy/cppy.h>
+#include <cstddef>
 #include <sstream>
+#include <structmember.h>
+#include "freelist.h"
 #include "symbolics.h"
 #include "types.h"
 #include "util.h"
@@ -41,16 +44,27 @@ Expression_new( PyTypeObject* type, PyObject* args, PyObject* kwargs )
     double constant = 0.0;
     if( pyconstant && !convert_to_double( pyconstant, constant ) )
         return 0;
-    PyObject* pyexpr = PyType_GenericNew( type, args, kwargs );
+    PyObject* pyexpr = type->tp_alloc( type, end );
     if( !pyexpr )
         return 0;
     Expression* self = reinterpret_cast<Expression*>( pyexpr );
-    self->terms = terms.release();
+    for( Py_ssize_t i = 0; i < end; ++i )
+    {
+        Term* term = reinterpret_cast<Term*>( PyTuple_GET_ITEM( terms.get(), i ) );
+        self->items[ i ].variable = cppy::incref( term->variable );
+        self->items[ i ].coefficient = term->coefficient;
+    }
     self->constant = constant;
+    // The given terms are kept, so that terms() returns the same objects.
+    self->terms = terms.release();
     return pyexpr;
 }
 
 
+/* The items are immutable, so only the cached tuple of terms is cleared.
+A cycle through the variables is broken by clearing their context.
+
+*/
 void
 Expression_clear( Expression* self )
 {
@@ -61,6 +75,9 @@ Expression_clear( Expression* self )
 int
 Expression_traverse( Expression* self, visitproc visit, void* arg )
 {
+    Py_ssize_t size = Py_SIZE( self );
+    for( Py_ssize_t i = 0; i < size; ++i )
+        Py_VISIT( self->items[ i ].variable );
     Py_VISIT( self->terms );
 #if PY_VERSION_HEX >= 0x03090000
     // This was not needed before Python 3.9 (Python issue 35810 and 40217)
@@ -74,7 +91,12 @@ void
 Expression_dealloc( Expression* self )
 {
     PyObject_GC_UnTrack( self );
+    if( self->weakreflist )
+        PyObject_ClearWeakRefs( pyobject_cast( self ) );
     Expression_clear( self );
+    Py_ssize_t size = Py_SIZE( self );
+    for( Py_ssize_t i = 0; i < size; ++i )
+        Py_XDECREF( self->items[ i ].variable );
     Py_TYPE( self )->tp_free( pyobject_cast( self ) );
 }
 
@@ -83,15 +105,11 @@ PyObject*
 Expression_repr( Expression* self )
 {
     std::stringstream stream;
-    Py_ssize_t end = PyTuple_GET_SIZE( self->terms );
+    Py_ssize_t end = Py_SIZE( self );
     for( Py_ssize_t i = 0; i < end; ++i )
     {
-        PyObject* item = PyTuple_GET_ITEM( self->terms, i );
-        Term* term = reinterpret_cast<Term*>( item );
-        stream << term->coefficient << " * ";
-        ACQUIRE_GLOBAL_LOCK();
-        std::string name = reinterpret_cast<Variable*>( term->variable )->variable.name();
-        RELEASE_GLOBAL_LOCK();
+        stream << self->items[ i ].coefficient << " * ";
+        std::string name = variable_name( self->items[ i ].variable );
         stream << name;
         stream << " + ";
     }
@@ -100,10 +118,39 @@ Expression_repr( Expression* self )
 }
 
 
+PyObject*
+make_terms( Expression* self )
+{
+    Py_ssize_t size = Py_SIZE( self );
+    cppy::ptr terms( PyTuple_New( size ) );
+    if( !terms )
+        return 0;
+    for( Py_ssize_t i = 0; i < size; ++i ) // zero tuple for safe early return
+        PyTuple_SET_ITEM( terms.get(), i, 0 );
+    for( Py_ssize_t i = 0; i < size; ++i )
+    {
+        PyObject* pyterm = PyType_GenericNew( Term::TypeObject, 0, 0 );
+        if( !pyterm )
+            return 0;
+        Term* term = reinterpret_cast<Term*>( pyterm );
+        term->variable = cppy::incref( self->items[ i ].variable );
+        term->coefficient = self->items[ i ].coefficient;
+        PyTuple_SET_ITEM( terms.get(), i, pyterm );
+    }
+    return terms.release();
+}
+
+
 PyObject*
 Expression_terms( Expression* self )
 {
-    return cppy::incref( self->terms );
+    PyObject* terms = 0;
+    Py_BEGIN_CRITICAL_SECTION( self );
+    if( !self->terms )
+        self->terms = make_terms( self );
+    terms = cppy::xincref( self->terms );
+    Py_END_CRITICAL_SECTION();
+    return terms;
 }
 
 
@@ -118,16 +165,11 @@ PyObject*
 Expression_value( Expression* self )
 {
     double result = self->constant;
-    Py_ssize_t size = PyTuple_GET_SIZE( self->terms );
+    Py_ssize_t size = Py_SIZE( self );
     for( Py_ssize_t i = 0; i < size; ++i )
     {
-        PyObject* item = PyTuple_GET_ITEM( self->terms, i );
-        Term* term = reinterpret_cast<Term*>( item );
-        Variable* pyvar = reinterpret_cast<Variable*>( term->variable );
-        ACQUIRE_GLOBAL_LOCK();
-        double value = pyvar->variable.value();
-        RELEASE_GLOBAL_LOCK();
-        result += term->coefficient * value;
+        Variable* pyvar = reinterpret_cast<Variable*>( self->items[ i ].variable );
+        result += self->items[ i ].coefficient * pyvar->variable.value();
     }
     return PyFloat_FromDouble( result );
 }
@@ -206,6 +248,13 @@ Expression_methods[] = {
 };
 
 
+static PyMemberDef
+Expression_members[] = {
+    { "__weaklistoffset__", T_PYSSIZET, offsetof( Expression, weakreflist ), READONLY, 0 },
+    { 0 } // sentinel
+};
+
+
 static PyType_Slot Expression_Type_slots[] = {
     { Py_tp_dealloc, void_cast( Expression_dealloc ) },      /* tp_dealloc */
     { Py_tp_traverse, void_cast( Expression_traverse ) },    /* tp_traverse */
@@ -213,9 +262,10 @@ static PyType_Slot Expression_Type_slots[] = {
     { Py_tp_repr, void_cast( Expression_repr ) },            /* tp_repr */
     { Py_tp_richcompare, void_cast( Expression_richcmp ) },  /* tp_richcompare */
     { Py_tp_methods, void_cast( Expression_methods ) },      /* tp_methods */
+    { Py_tp_members, void_cast( Expression_members ) },      /* tp_members */
     { Py_tp_new, void_cast( Expression_new ) },              /* tp_new */
-    { Py_tp_alloc, void_cast( PyType_GenericAlloc ) },       /* tp_alloc */
-    { Py_tp_free, void_cast( PyObject_GC_Del ) },            /* tp_free */
+    { Py_tp_alloc, void_cast( VarFreeList<Expression>::alloc ) }, /* tp_alloc */
+    { Py_tp_free, void_cast( VarFreeList<Expression>::free ) },   /* tp_free */
     { Py_nb_add, void_cast( Expression_add ) },              /* nb_add */
     { Py_nb_subtract, void_cast( Expression_sub ) },         /* nb_sub */
     { Py_nb_multiply, void_cast( Expression_mul ) },         /* nb_mul */
@@ -234,8 +284,8 @@ PyTypeObject* Expression::TypeObject = NULL;
 
 PyType_Spec Expression::TypeObject_Spec = {
 	"kiwisolver.Expression",             /* tp_name */
-	sizeof( Expression ),                /* tp_basicsize */
-	0,                                   /* tp_itemsize */
+	offsetof( Expression, items ),       /* tp_basicsize */
+	sizeof( Expression::Item ),          /* tp_itemsize */
 	Py_TPFLAGS_DEFAULT|
     Py_TPFLAGS_HAVE_GC|
     Py_TPFLAGS_BASETYPE,                 /* tp_flags */
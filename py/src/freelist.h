@@ -0,0 +1,147 @@
+/*-----------------------------------------------------------------------------
+| Copyright (c) 2013-2026, Nucleic Development Team.
+|
+| Distributed under the terms of the Modified BSD License.
+|
+| The full license is in the file LICENSE, distributed with this software.
+|----------------------------------------------------------------------------*/
+#pragma once
+#include <Python.h>
+#include <cstddef>
+#include <cstring>
+
+
+namespace kiwisolver
+{
+
+/* The freelists are only used where the GIL serializes the allocations,
+and where the objects are laid out by CPython itself.
+
+*/
+#if !defined(Py_GIL_DISABLED) && !defined(PYPY_VERSION)
+#define KIWI_PY_FREELISTS
+#endif
+
+
+/* A freelist of the exact instances of a GC type.
+
+The `alloc` and `free` functions replace PyType_GenericAlloc and
+PyObject_GC_Del in the slots of the type. The memory of a freed object,
+which is untracked by its dealloc, is kept for the next allocation.
+Instances of subclasses always go through the regular allocator.
+
+*/
+template<typename T, std::size_t N = 256>
+class FreeList
+{
+
+public:
+
+	static PyObject* alloc( PyTypeObject* type, Py_ssize_t nitems )
+	{
+#if defined(KIWI_PY_FREELISTS)
+		if( type == T::TypeObject && s_count > 0 )
+		{
+			PyObject* op = s_items[ --s_count ];
+			std::memset(
+				reinterpret_cast<char*>( op ) + sizeof( PyObject ), 0,
+				sizeof( T ) - sizeof( PyObject ) );
+			PyObject_Init( op, type );
+			PyObject_GC_Track( op );
+			return op;
+		}
+#endif
+		return PyType_GenericAlloc( type, nitems );
+	}
+
+	static void free( void* ptr )
+	{
+#if defined(KIWI_PY_FREELISTS)
+		PyObject* op = static_cast<PyObject*>( ptr );
+		if( Py_TYPE( op ) == T::TypeObject && s_count < N )
+		{
+			s_items[ s_count++ ] = op;
+			return;
+		}
+#endif
+		PyObject_GC_Del( ptr );
+	}
+
+private:
+
+#if defined(KIWI_PY_FREELISTS)
+	static PyObject* s_items[ N ];
+	static std::size_t s_count;
+#endif
+};
+
+
+/* A freelist of the exact instances of a variable-size GC type.
+
+Like the tuples of CPython, the freed objects are kept by their number of
+items, so that a reused object always has the room for its items. Objects
+with S items or more always go through the regular allocator.
+
+*/
+template<typename T, std::size_t S = 8, std::size_t N = 64>
+class VarFreeList
+{
+
+public:
+
+	static PyObject* alloc( PyTypeObject* type, Py_ssize_t nitems )
+	{
+#if defined(KIWI_PY_FREELISTS)
+		if( type == T::TypeObject && nitems >= 0 &&
+			static_cast<std::size_t>( nitems ) < S && s_count[ nitems ] > 0 )
+		{
+			PyObject* op = s_items[ nitems ][ --s_count[ nitems ] ];
+			std::memset(
+				reinterpret_cast<char*>( op ) + sizeof( PyObject ), 0,
+				type->tp_basicsize + nitems * type->tp_itemsize - sizeof( PyObject ) );
+			PyObject_InitVar( reinterpret_cast<PyVarObject*>( op ), type, nitems );
+			PyObject_GC_Track( op );
+			return op;
+		}
+#endif
+		return PyType_GenericAlloc( type, nitems );
+	}
+
+	static void free( void* ptr )
+	{
+#if defined(KIWI_PY_FREELISTS)
+		PyObject* op = static_cast<PyObject*>( ptr );
+		std::size_t size = static_cast<std::size_t>( Py_SIZE( op ) );
+		if( Py_TYPE( op ) == T::TypeObject && size < S && s_count[ size ] < N )
+		{
+			s_items[ size ][ s_count[ size ]++ ] = op;
+			return;
+		}
+#endif
+		PyObject_GC_Del( ptr );
+	}
+
+private:
+
+#if defined(KIWI_PY_FREELISTS)
+	static PyObject* s_items[ S ][ N ];
+	static std::size_t s_count[ S ];
+#endif
+};
+
+
+#if defined(KIWI_PY_FREELISTS)
+template<typename T, std::size_t N>
+PyObject* FreeList<T, N>::s_items[ N ];
+
+template<typename T, std::size_t N>
+std::size_t FreeList<T, N>::s_count = 0;
+
+template<typename T, std::size_t S, std::size_t N>
+PyObject* VarFreeList<T, S, N>::s_items[ S ][ N ];
+
+template<typename T, std::size_t S, std::size_t N>
+std::size_t VarFreeList<T, S, N>::s_count[ S ];
+#endif
+
+}  // namespace kiwisolver
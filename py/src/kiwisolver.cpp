@@ -6,18 +6,10 @@
 | The full license is in the file LICENSE, distributed with this software.
 |----------------------------------------------------------------------------*/
 #include <cppy/cppy.h>
-#include <mutex>
 #include <kiwi/kiwi.h>
 #include "types.h"
 #include "version.h"
 
-namespace kiwisolver
-{
-
-std::recursive_mutex global_lock;
-
-}
-
 namespace
 {
 
@@ -37,6 +29,10 @@ bool ready_types()
     {
         return false;
     }
+    if( !LinearExpression::Ready() )
+    {
+        return false;
+    }
     if( !Constraint::Ready() )
     {
         return false;
@@ -114,6 +110,14 @@ bool add_objects( PyObject* mod )
 	}
     expr.release();
 
+    // LinearExpression
+    cppy::ptr linexpr( pyobject_cast( LinearExpression::TypeObject ) );
+	if( PyModule_AddObject( mod, "LinearExpression", linexpr.get() ) < 0 )
+	{
+		return false;
+	}
+    linexpr.release();
+
     // Constraint
     cppy::ptr cons( pyobject_cast( Constraint::TypeObject ) );
 	if( PyModule_AddObject( mod, "Constraint", cons.get() ) < 0 )
@@ -136,6 +140,18 @@ bool add_objects( PyObject* mod )
     PyModule_AddObject( mod, "UnknownEditVariable", UnknownEditVariable );
     PyModule_AddObject( mod, "BadRequiredStrength", BadRequiredStrength );
 
+    // C API for other extensions
+    cppy::ptr capi( new_capi_capsule() );
+    if( !capi )
+    {
+        return false;
+    }
+    if( PyModule_AddObject( mod, "_C_API", capi.get() ) < 0 )
+    {
+        return false;
+    }
+    capi.release();
+
 	return true;
 }
 
@@ -0,0 +1,452 @@
+/*-----------------------------------------------------------------------------
+| Copyright (c) 2013-2026, Nucleic Development Team.
+|
+| Distributed under the terms of the Modified BSD License.
+|
+| The full license is in the file LICENSE, distributed with this software.
+|----------------------------------------------------------------------------*/
+#include <cppy/cppy.h>
+#include <map>
+#include <sstream>
+#include "types.h"
+#include "util.h"
+
+
+namespace kiwisolver
+{
+
+namespace
+{
+
+typedef std::vector<std::pair<PyObject*, double>> TermVector;
+
+
+/* Copy the terms of a linear expression, with new references.
+
+*/
+void
+copy_terms( LinearExpression* source, double factor, TermVector& out, double& constant )
+{
+    Py_BEGIN_CRITICAL_SECTION( source );
+    out.reserve( out.size() + source->terms.size() );
+    for( const auto& term : source->terms )
+        out.push_back( std::make_pair( cppy::incref( term.first ), term.second * factor ) );
+    constant += source->constant * factor;
+    Py_END_CRITICAL_SECTION();
+}
+
+
+/* Add factor * value to the expression.
+
+Returns 1 on success, 0 if the value is not a symbolic or numeric type,
+and -1 on error. The caller holds the critical section of self.
+
+*/
+int
+LinearExpression_append( LinearExpression* self, PyObject* value, double factor )
+{
+    if( Variable::TypeCheck( value ) )
+    {
+        self->terms.push_back( std::make_pair( cppy::incref( value ), factor ) );
+        return 1;
+    }
+    if( Term::TypeCheck( value ) )
+    {
+        Term* term = reinterpret_cast<Term*>( value );
+        self->terms.push_back(
+            std::make_pair( cppy::incref( term->variable ), term->coefficient * factor ) );
+        return 1;
+    }
+    if( Expression::TypeCheck( value ) )
+    {
+        Expression* expr = reinterpret_cast<Expression*>( value );
+        Py_ssize_t size = Py_SIZE( expr );
+        self->terms.reserve( self->terms.size() + size );
+        for( Py_ssize_t i = 0; i < size; ++i )
+        {
+            const Expression::Item& item = expr->items[ i ];
+            self->terms.push_back(
+                std::make_pair( cppy::incref( item.variable ), item.coefficient * factor ) );
+        }
+        self->constant += expr->constant * factor;
+        return 1;
+    }
+    if( LinearExpression::TypeCheck( value ) )
+    {
+        // Copy first, since the value may be self.
+        TermVector terms;
+        double constant = 0.0;
+        copy_terms( reinterpret_cast<LinearExpression*>( value ), factor, terms, constant );
+        self->terms.insert( self->terms.end(), terms.begin(), terms.end() );
+        self->constant += constant;
+        return 1;
+    }
+    if( PyFloat_Check( value ) || PyLong_Check( value ) )
+    {
+        double number;
+        if( !convert_to_double( value, number ) )
+            return -1;
+        self->constant += number * factor;
+        return 1;
+    }
+    return 0;
+}
+
+
+/* Reduce the terms into a new Expression.
+
+*/
+PyObject*
+LinearExpression_reduce( LinearExpression* self )
+{
+    std::map<PyObject*, double> coeffs;
+    double constant;
+    Py_BEGIN_CRITICAL_SECTION( self );
+    for( const auto& term : self->terms )
+        coeffs[ term.first ] += term.second;
+    constant = self->constant;
+    Py_END_CRITICAL_SECTION();
+    return make_expression( coeffs, constant );
+}
+
+
+PyObject*
+LinearExpression_new( PyTypeObject* type, PyObject* args, PyObject* kwargs )
+{
+    static const char *kwlist[] = { "constant", 0 };
+    PyObject* pyconstant = 0;
+    if( !PyArg_ParseTupleAndKeywords(
+        args, kwargs, "|O:__new__", const_cast<char**>( kwlist ),
+        &pyconstant ) )
+        return 0;
+    double constant = 0.0;
+    if( pyconstant && !convert_to_double( pyconstant, constant ) )
+        return 0;
+    PyObject* pyexpr = PyType_GenericNew( type, args, kwargs );
+    if( !pyexpr )
+        return 0;
+    LinearExpression* self = reinterpret_cast<LinearExpression*>( pyexpr );
+    new( &self->terms ) TermVector();
+    self->constant = constant;
+    return pyexpr;
+}
+
+
+int
+LinearExpression_clear( LinearExpression* self )
+{
+    TermVector terms;
+    terms.swap( self->terms );
+    for( const auto& term : terms )
+        Py_DECREF( term.first );
+    return 0;
+}
+
+
+int
+LinearExpression_traverse( LinearExpression* self, visitproc visit, void* arg )
+{
+    for( const auto& term : self->terms )
+        Py_VISIT( term.first );
+#if PY_VERSION_HEX >= 0x03090000
+    // This was not needed before Python 3.9 (Python issue 35810 and 40217)
+    Py_VISIT(Py_TYPE(self));
+#endif
+    return 0;
+}
+
+
+void
+LinearExpression_dealloc( LinearExpression* self )
+{
+    PyObject_GC_UnTrack( self );
+    LinearExpression_clear( self );
+    self->terms.~TermVector();
+    Py_TYPE( self )->tp_free( pyobject_cast( self ) );
+}
+
+
+PyObject*
+LinearExpression_repr( LinearExpression* self )
+{
+    cppy::ptr pyexpr( LinearExpression_reduce( self ) );
+    if( !pyexpr )
+        return 0;
+    Expression* expr = reinterpret_cast<Expression*>( pyexpr.get() );
+    std::stringstream stream;
+    Py_ssize_t end = Py_SIZE( expr );
+    for( Py_ssize_t i = 0; i < end; ++i )
+    {
+        stream << expr->items[ i ].coefficient << " * ";
+        std::string name = variable_name( expr->items[ i ].variable );
+        stream << name;
+        stream << " + ";
+    }
+    stream << expr->constant;
+    return PyUnicode_FromString( stream.str().c_str() );
+}
+
+
+PyObject*
+LinearExpression_addTerm( LinearExpression* self, PyObject* args )
+{
+    PyObject* pyvar;
+    PyObject* pycoeff = 0;
+    if( !PyArg_ParseTuple( args, "O|O", &pyvar, &pycoeff ) )
+        return 0;
+    if( !Variable::TypeCheck( pyvar ) )
+        return cppy::type_error( pyvar, "Variable" );
+    double coefficient = 1.0;
+    if( pycoeff && !convert_to_double( pycoeff, coefficient ) )
+        return 0;
+    Py_BEGIN_CRITICAL_SECTION( self );
+    self->terms.push_back( std::make_pair( cppy::incref( pyvar ), coefficient ) );
+    Py_END_CRITICAL_SECTION();
+    Py_RETURN_NONE;
+}
+
+
+PyObject*
+LinearExpression_addTerms( LinearExpression* self, PyObject* args )
+{
+    PyObject* pyvars;
+    PyObject* pycoeffs = 0;
+    if( !PyArg_ParseTuple( args, "O|O", &pyvars, &pycoeffs ) )
+        return 0;
+    cppy::ptr vars( PySequence_Fast( pyvars, "expected a sequence of Variable" ) );
+    if( !vars )
+        return 0;
+    Py_ssize_t size = PySequence_Fast_GET_SIZE( vars.get() );
+    PyObject** items = PySequence_Fast_ITEMS( vars.get() );
+    for( Py_ssize_t i = 0; i < size; ++i )
+    {
+        if( !Variable::TypeCheck( items[ i ] ) )
+            return cppy::type_error( items[ i ], "Variable" );
+    }
+    std::vector<double> coefficients( size, 1.0 );
+    if( pycoeffs && pycoeffs != Py_None )
+    {
+        cppy::ptr coeffs( PySequence_Fast( pycoeffs, "expected a sequence of numbers" ) );
+        if( !coeffs )
+            return 0;
+        if( PySequence_Fast_GET_SIZE( coeffs.get() ) != size )
+        {
+            PyErr_SetString(
+                PyExc_ValueError, "expected as many coefficients as variables" );
+            return 0;
+        }
+        for( Py_ssize_t i = 0; i < size; ++i )
+        {
+            if( !convert_to_double( PySequence_Fast_GET_ITEM( coeffs.get(), i ), coefficients[ i ] ) )
+                return 0;
+        }
+    }
+    Py_BEGIN_CRITICAL_SECTION( self );
+    self->terms.reserve( self->terms.size() + size );
+    for( Py_ssize_t i = 0; i < size; ++i )
+        self->terms.push_back( std::make_pair( cppy::incref( items[ i ] ), coefficients[ i ] ) );
+    Py_END_CRITICAL_SECTION();
+    Py_RETURN_NONE;
+}
+
+
+PyObject*
+LinearExpression_expression( LinearExpression* self )
+{
+    return LinearExpression_reduce( self );
+}
+
+
+PyObject*
+LinearExpression_value( LinearExpression* self )
+{
+    double result;
+    Py_BEGIN_CRITICAL_SECTION( self );
+    result = self->constant;
+    for( const auto& term : self->terms )
+    {
+        Variable* pyvar = reinterpret_cast<Variable*>( term.first );
+        result += term.second * pyvar->variable.value();
+    }
+    Py_END_CRITICAL_SECTION();
+    return PyFloat_FromDouble( result );
+}
+
+
+PyObject*
+LinearExpression_inplace( PyObject* first, PyObject* second, double factor )
+{
+    LinearExpression* self = reinterpret_cast<LinearExpression*>( first );
+    int result;
+    Py_BEGIN_CRITICAL_SECTION( self );
+    result = LinearExpression_append( self, second, factor );
+    Py_END_CRITICAL_SECTION();
+    if( result < 0 )
+        return 0;
+    if( result == 0 )
+        Py_RETURN_NOTIMPLEMENTED;
+    return cppy::incref( first );
+}
+
+
+PyObject*
+LinearExpression_iadd( PyObject* first, PyObject* second )
+{
+    return LinearExpression_inplace( first, second, 1.0 );
+}
+
+
+PyObject*
+LinearExpression_isub( PyObject* first, PyObject* second )
+{
+    return LinearExpression_inplace( first, second, -1.0 );
+}
+
+
+/* Make a new expression holding first + factor * second.
+
+*/
+PyObject*
+LinearExpression_combine( PyObject* first, PyObject* second, double factor )
+{
+    cppy::ptr pyexpr( PyType_GenericNew( LinearExpression::TypeObject, 0, 0 ) );
+    if( !pyexpr )
+        return 0;
+    LinearExpression* self = reinterpret_cast<LinearExpression*>( pyexpr.get() );
+    new( &self->terms ) TermVector();
+    self->constant = 0.0;
+    int result = LinearExpression_append( self, first, 1.0 );
+    if( result > 0 )
+        result = LinearExpression_append( self, second, factor );
+    if( result < 0 )
+        return 0;
+    if( result == 0 )
+        Py_RETURN_NOTIMPLEMENTED;
+    return pyexpr.release();
+}
+
+
+PyObject*
+LinearExpression_add( PyObject* first, PyObject* second )
+{
+    return LinearExpression_combine( first, second, 1.0 );
+}
+
+
+PyObject*
+LinearExpression_sub( PyObject* first, PyObject* second )
+{
+    return LinearExpression_combine( first, second, -1.0 );
+}
+
+
+/* Make the constraint first - second op 0, reducing the terms once.
+
+*/
+PyObject*
+LinearExpression_makecn( PyObject* first, PyObject* second, kiwi::RelationalOperator op )
+{
+    cppy::ptr pydiff( LinearExpression_combine( first, second, -1.0 ) );
+    if( !pydiff || pydiff.get() == Py_NotImplemented )
+        return pydiff.release();
+    cppy::ptr pycn( PyType_GenericNew( Constraint::TypeObject, 0, 0 ) );
+    if( !pycn )
+        return 0;
+    Constraint* cn = reinterpret_cast<Constraint*>( pycn.get() );
+    cn->expression = LinearExpression_reduce( reinterpret_cast<LinearExpression*>( pydiff.get() ) );
+    if( !cn->expression )
+        return 0;
+    kiwi::Expression expr( convert_to_kiwi_expression( cn->expression ) );
+    new( &cn->constraint ) kiwi::Constraint( expr, op, kiwi::strength::required );
+    return pycn.release();
+}
+
+
+PyObject*
+LinearExpression_richcmp( PyObject* first, PyObject* second, int op )
+{
+    switch( op )
+    {
+        case Py_EQ:
+            return LinearExpression_makecn( first, second, kiwi::OP_EQ );
+        case Py_LE:
+            return LinearExpression_makecn( first, second, kiwi::OP_LE );
+        case Py_GE:
+            return LinearExpression_makecn( first, second, kiwi::OP_GE );
+        default:
+            break;
+    }
+    PyErr_Format(
+        PyExc_TypeError,
+        "unsupported operand type(s) for %s: "
+        "'%.100s' and '%.100s'",
+        pyop_str( op ),
+        Py_TYPE( first )->tp_name,
+        Py_TYPE( second )->tp_name
+    );
+    return 0;
+}
+
+
+static PyMethodDef
+LinearExpression_methods[] = {
+    { "addTerm", ( PyCFunction )LinearExpression_addTerm, METH_VARARGS,
+      "Add a variable with a coefficient, by default 1, to the expression." },
+    { "addTerms", ( PyCFunction )LinearExpression_addTerms, METH_VARARGS,
+      "Add a sequence of variables with a sequence of coefficients to the expression." },
+    { "expression", ( PyCFunction )LinearExpression_expression, METH_NOARGS,
+      "Get the reduced Expression for the sum." },
+    { "value", ( PyCFunction )LinearExpression_value, METH_NOARGS,
+      "Get the value for the expression." },
+    { 0 } // sentinel
+};
+
+
+static PyType_Slot LinearExpression_Type_slots[] = {
+    { Py_tp_dealloc, void_cast( LinearExpression_dealloc ) },      /* tp_dealloc */
+    { Py_tp_traverse, void_cast( LinearExpression_traverse ) },    /* tp_traverse */
+    { Py_tp_clear, void_cast( LinearExpression_clear ) },          /* tp_clear */
+    { Py_tp_repr, void_cast( LinearExpression_repr ) },            /* tp_repr */
+    { Py_tp_richcompare, void_cast( LinearExpression_richcmp ) },  /* tp_richcompare */
+    { Py_tp_methods, void_cast( LinearExpression_methods ) },      /* tp_methods */
+    { Py_tp_new, void_cast( LinearExpression_new ) },              /* tp_new */
+    { Py_tp_alloc, void_cast( PyType_GenericAlloc ) },             /* tp_alloc */
+    { Py_tp_free, void_cast( PyObject_GC_Del ) },                  /* tp_free */
+    { Py_nb_add, void_cast( LinearExpression_add ) },              /* nb_add */
+    { Py_nb_subtract, void_cast( LinearExpression_sub ) },         /* nb_subtract */
+    { Py_nb_inplace_add, void_cast( LinearExpression_iadd ) },     /* nb_inplace_add */
+    { Py_nb_inplace_subtract, void_cast( LinearExpression_isub ) },/* nb_inplace_subtract */
+    { 0, 0 },
+};
+
+
+} // namespace
+
+
+// Initialize static variables (otherwise the compiler eliminates them)
+PyTypeObject* LinearExpression::TypeObject = NULL;
+
+
+PyType_Spec LinearExpression::TypeObject_Spec = {
+	"kiwisolver.LinearExpression",       /* tp_name */
+	sizeof( LinearExpression ),          /* tp_basicsize */
+	0,                                   /* tp_itemsize */
+	Py_TPFLAGS_DEFAULT|
+    Py_TPFLAGS_HAVE_GC|
+    Py_TPFLAGS_BASETYPE,                 /* tp_flags */
+    LinearExpression_Type_slots          /* slots */
+};
+
+
+bool LinearExpression::Ready()
+{
+    // The reference will be handled by the module to which we will add the type
+	TypeObject = pytype_cast( PyType_FromSpec( &TypeObject_Spec ) );
+    if( !TypeObject )
+    {
+        return false;
+    }
+    return true;
+}
+
+}  // namespace kiwisolver
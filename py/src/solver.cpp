@@ -6,6 +6,12 @@
 | The full license is in the file LICENSE, distributed with this software.
 |----------------------------------------------------------------------------*/
 #include <cppy/cppy.h>
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
 #include <kiwi/kiwi.h>
 #include "types.h"
 #include "util.h"
@@ -17,6 +23,223 @@ namespace kiwisolver
 namespace
 {
 
+/* Get the items of a sequence argument as a list or a tuple.
+
+A list of the caller is copied to a tuple, since it could be changed by
+another thread, or by the conversion of its items, while it is in use.
+
+*/
+PyObject*
+snapshot_sequence( PyObject* arg, const char* message )
+{
+	cppy::ptr items( PySequence_Fast( arg, message ) );
+	if( !items || items.get() != arg || !PyList_Check( arg ) )
+		return items.release();
+	return PyList_AsTuple( arg );
+}
+
+
+/* Collect the constraints of a sequence.
+
+The items stay owned by the returned snapshot of the sequence.
+
+*/
+bool
+collect_constraints( PyObject* arg, cppy::ptr& items, std::vector<kiwi::Constraint>& out )
+{
+	items = snapshot_sequence( arg, "expected a sequence of Constraint" );
+	if( !items )
+		return false;
+	Py_ssize_t size = PySequence_Fast_GET_SIZE( items.get() );
+	PyObject** objects = PySequence_Fast_ITEMS( items.get() );
+	out.reserve( size );
+	for( Py_ssize_t i = 0; i < size; ++i )
+	{
+		if( !Constraint::TypeCheck( objects[ i ] ) )
+		{
+			cppy::type_error( objects[ i ], "Constraint" );
+			return false;
+		}
+		out.push_back( reinterpret_cast<Constraint*>( objects[ i ] )->constraint );
+	}
+	return true;
+}
+
+
+/* Collect the values of a sequence of (Variable, value) pairs.
+
+The values are converted by `convert`, and the variables are appended to
+`pyvars` so that a failure can be reported with the offending variable.
+
+*/
+bool
+collect_pairs( PyObject* arg,
+			   bool ( *convert )( PyObject*, double& ),
+			   std::vector<cppy::ptr>& pyvars,
+			   std::vector<std::pair<kiwi::Variable, double>>& out )
+{
+	cppy::ptr items( snapshot_sequence( arg, "expected a sequence of pairs" ) );
+	if( !items )
+		return false;
+	Py_ssize_t size = PySequence_Fast_GET_SIZE( items.get() );
+	pyvars.reserve( size );
+	out.reserve( size );
+	for( Py_ssize_t i = 0; i < size; ++i )
+	{
+		cppy::ptr pair( snapshot_sequence(
+			PySequence_Fast_GET_ITEM( items.get(), i ), "expected a pair" ) );
+		if( !pair )
+			return false;
+		if( PySequence_Fast_GET_SIZE( pair.get() ) != 2 )
+		{
+			PyErr_SetString( PyExc_TypeError, "expected a pair" );
+			return false;
+		}
+		PyObject* pyvar = PySequence_Fast_GET_ITEM( pair.get(), 0 );
+		if( !Variable::TypeCheck( pyvar ) )
+		{
+			cppy::type_error( pyvar, "Variable" );
+			return false;
+		}
+		double value;
+		if( !convert( PySequence_Fast_GET_ITEM( pair.get(), 1 ), value ) )
+			return false;
+		pyvars.push_back( cppy::ptr( cppy::incref( pyvar ) ) );
+		out.push_back( std::make_pair( reinterpret_cast<Variable*>( pyvar )->variable, value ) );
+	}
+	return true;
+}
+
+
+/* A one dimensional buffer of numbers, released on destruction.
+
+*/
+class NumberBuffer
+{
+
+public:
+
+	NumberBuffer() : m_acquired( false ), m_format( 0 ) {}
+
+	~NumberBuffer()
+	{
+		if( m_acquired )
+			PyBuffer_Release( &m_view );
+	}
+
+	/* Acquire the buffer of an object, which must hold native integers
+	or, if `real` is true, native floating point numbers.
+
+	*/
+	bool acquire( PyObject* obj, const char* name, bool real )
+	{
+		if( PyObject_GetBuffer( obj, &m_view, PyBUF_FORMAT | PyBUF_STRIDES ) != 0 )
+			return false;
+		m_acquired = true;
+		const char* format = m_view.format ? m_view.format : "B";
+		if( *format == '@' || *format == '=' )
+			++format;
+		m_format = format[ 0 ] != '\0' && format[ 1 ] == '\0' ? format[ 0 ] : 0;
+		const char* accepted = real ? "fd" : "bBhHiIlLqQnN";
+		if( m_view.ndim != 1 || m_format == 0 || !std::strchr( accepted, m_format ) )
+		{
+			PyErr_Format(
+				PyExc_TypeError,
+				"%s must be a one dimensional buffer of %s",
+				name, real ? "floats" : "integers" );
+			return false;
+		}
+		return true;
+	}
+
+	Py_ssize_t size() const
+	{
+		return m_view.shape[ 0 ];
+	}
+
+	double real( Py_ssize_t i ) const
+	{
+		const char* item = static_cast<const char*>( m_view.buf ) + i * m_view.strides[ 0 ];
+		if( m_format == 'f' )
+			return load<float>( item );
+		return load<double>( item );
+	}
+
+	long long integer( Py_ssize_t i ) const
+	{
+		const char* item = static_cast<const char*>( m_view.buf ) + i * m_view.strides[ 0 ];
+		switch( m_format )
+		{
+		case 'b': return load<signed char>( item );
+		case 'B': return load<unsigned char>( item );
+		case 'h': return load<short>( item );
+		case 'H': return load<unsigned short>( item );
+		case 'i': return load<int>( item );
+		case 'I': return load<unsigned int>( item );
+		case 'l': return load<long>( item );
+		case 'L': return static_cast<long long>( load<unsigned long>( item ) );
+		case 'q': return load<long long>( item );
+		case 'Q': return static_cast<long long>( load<unsigned long long>( item ) );
+		case 'n': return load<Py_ssize_t>( item );
+		default: return static_cast<long long>( load<std::size_t>( item ) );
+		}
+	}
+
+private:
+
+	NumberBuffer( const NumberBuffer& );
+
+	NumberBuffer& operator=( const NumberBuffer& );
+
+	template<typename T>
+	static T load( const char* item )
+	{
+		T value;
+		std::memcpy( &value, item, sizeof( T ) );
+		return value;
+	}
+
+	Py_buffer m_view;
+	bool m_acquired;
+	char m_format;
+};
+
+
+/* Convert an argument which is either one item or a sequence of one item
+per row.
+
+*/
+template<typename T>
+bool
+convert_per_row( PyObject* arg, bool single, Py_ssize_t rows,
+				 bool ( *convert )( PyObject*, T& ), std::vector<T>& out )
+{
+	if( single )
+	{
+		T value;
+		if( !convert( arg, value ) )
+			return false;
+		out.assign( rows, value );
+		return true;
+	}
+	cppy::ptr items( snapshot_sequence( arg, "expected a sequence" ) );
+	if( !items )
+		return false;
+	if( PySequence_Fast_GET_SIZE( items.get() ) != rows )
+	{
+		PyErr_Format( PyExc_ValueError, "expected %zd items, one per row", rows );
+		return false;
+	}
+	out.resize( rows );
+	for( Py_ssize_t i = 0; i < rows; ++i )
+	{
+		if( !convert( PySequence_Fast_GET_ITEM( items.get(), i ), out[ i ] ) )
+			return false;
+	}
+	return true;
+}
+
+
 PyObject*
 Solver_new( PyTypeObject* type, PyObject* args, PyObject* kwargs )
 {
@@ -26,9 +249,9 @@ Solver_new( PyTypeObject* type, PyObject* args, PyObject* kwargs )
 	if( !pysolver )
 		return 0;
 	Solver* self = reinterpret_cast<Solver*>( pysolver );
-	ACQUIRE_GLOBAL_LOCK();
 	new( &self->solver ) kiwi::Solver();
-	RELEASE_GLOBAL_LOCK();
+	new( &self->mutex ) std::mutex();
+	self->gil_threshold = 1000;
 	return pysolver;
 }
 
@@ -36,9 +259,8 @@ Solver_new( PyTypeObject* type, PyObject* args, PyObject* kwargs )
 void
 Solver_dealloc( Solver* self )
 {
-	ACQUIRE_GLOBAL_LOCK();
+	self->mutex.~mutex();
 	self->solver.~Solver();
-	RELEASE_GLOBAL_LOCK();
 	Py_TYPE( self )->tp_free( pyobject_cast( self ) );
 }
 
@@ -49,44 +271,241 @@ Solver_addConstraint( Solver* self, PyObject* other )
 	if( !Constraint::TypeCheck( other ) )
 		return cppy::type_error( other, "Constraint" );
 	Constraint* cn = reinterpret_cast<Constraint*>( other );
-	try
+	PyObject* error = 0;
 	{
-		ACQUIRE_GLOBAL_LOCK();
-		self->solver.addConstraint( cn->constraint );
-		RELEASE_GLOBAL_LOCK();
+		SolverGuard guard( self );
+		try
+		{
+			self->solver.addConstraint( cn->constraint );
+		}
+		catch( const kiwi::DuplicateConstraint& )
+		{
+			error = DuplicateConstraint;
+		}
+		catch( const kiwi::UnsatisfiableConstraint& )
+		{
+			error = UnsatisfiableConstraint;
+		}
 	}
-	catch( const kiwi::DuplicateConstraint& )
+	if( error )
 	{
-		RELEASE_GLOBAL_LOCK();
-		PyErr_SetObject( DuplicateConstraint, other );
+		PyErr_SetObject( error, other );
 		return 0;
 	}
-	catch( const kiwi::UnsatisfiableConstraint& )
+	Py_RETURN_NONE;
+}
+
+
+PyObject*
+Solver_addConstraints( Solver* self, PyObject* arg )
+{
+	cppy::ptr items;
+	std::vector<kiwi::Constraint> constraints;
+	if( !collect_constraints( arg, items, constraints ) )
+		return 0;
+	PyObject* error = 0;
+	Py_ssize_t index = 0;
 	{
-		RELEASE_GLOBAL_LOCK();
-		PyErr_SetObject( UnsatisfiableConstraint, other );
+		SolverGuard guard( self );
+		try
+		{
+			self->solver.addConstraints( constraints );
+		}
+		catch( const kiwi::DuplicateConstraint& e )
+		{
+			error = DuplicateConstraint;
+			index = find_constraint( constraints, e.constraint() );
+			assert( index >= 0 );
+		}
+		catch( const kiwi::UnsatisfiableConstraint& e )
+		{
+			error = UnsatisfiableConstraint;
+			index = find_constraint( constraints, e.constraint() );
+			assert( index >= 0 );
+		}
+	}
+	if( error )
+	{
+		PyErr_SetObject( error, PySequence_Fast_GET_ITEM( items.get(), index ) );
 		return 0;
 	}
 	Py_RETURN_NONE;
 }
 
 
+PyObject*
+Solver_addLinearConstraints( Solver* self, PyObject* args, PyObject* kwargs )
+{
+	static const char* kwlist[] = {
+		"variables", "indptr", "indices", "data", "rhs", "op", "strength", 0
+	};
+	PyObject* pyvars;
+	PyObject* pyindptr;
+	PyObject* pyindices;
+	PyObject* pydata;
+	PyObject* pyrhs;
+	PyObject* pyop;
+	PyObject* pystrength = 0;
+	if( !PyArg_ParseTupleAndKeywords(
+		args, kwargs, "OOOOOO|O:addLinearConstraints", const_cast<char**>( kwlist ),
+		&pyvars, &pyindptr, &pyindices, &pydata, &pyrhs, &pyop, &pystrength ) )
+		return 0;
+	cppy::ptr vars( snapshot_sequence( pyvars, "expected a sequence of Variable" ) );
+	if( !vars )
+		return 0;
+	Py_ssize_t varcount = PySequence_Fast_GET_SIZE( vars.get() );
+	PyObject** varitems = PySequence_Fast_ITEMS( vars.get() );
+	for( Py_ssize_t i = 0; i < varcount; ++i )
+	{
+		if( !Variable::TypeCheck( varitems[ i ] ) )
+			return cppy::type_error( varitems[ i ], "Variable" );
+	}
+	NumberBuffer indptr;
+	NumberBuffer indices;
+	NumberBuffer data;
+	NumberBuffer rhs;
+	if( !indptr.acquire( pyindptr, "indptr", false ) ||
+		!indices.acquire( pyindices, "indices", false ) ||
+		!data.acquire( pydata, "data", true ) ||
+		!rhs.acquire( pyrhs, "rhs", true ) )
+		return 0;
+	Py_ssize_t rows = rhs.size();
+	if( indptr.size() != rows + 1 || indices.size() != data.size() )
+	{
+		PyErr_SetString(
+			PyExc_ValueError,
+			"indptr must hold one more item than rhs, and indices as many as data" );
+		return 0;
+	}
+	std::vector<kiwi::RelationalOperator> ops;
+	if( !convert_per_row( pyop, PyUnicode_Check( pyop ), rows, convert_to_relational_op, ops ) )
+		return 0;
+	std::vector<double> strengths;
+	if( !pystrength )
+		strengths.assign( rows, kiwi::strength::required );
+	else if( !convert_per_row(
+		pystrength,
+		PyUnicode_Check( pystrength ) || PyFloat_Check( pystrength ) || PyLong_Check( pystrength ),
+		rows, convert_to_strength, strengths ) )
+		return 0;
+
+	// Each row is reduced like the expression of a Constraint, so that the
+	// resulting constraints are the same as those built with operators.
+	cppy::ptr pycns( PyList_New( rows ) );
+	if( !pycns )
+		return 0;
+	std::vector<kiwi::Constraint> constraints;
+	constraints.reserve( rows );
+	for( Py_ssize_t row = 0; row < rows; ++row )
+	{
+		long long begin = indptr.integer( row );
+		long long end = indptr.integer( row + 1 );
+		if( begin < 0 || end < begin || end > indices.size() )
+		{
+			PyErr_Format( PyExc_ValueError, "invalid indptr range for row %zd", row );
+			return 0;
+		}
+		std::map<PyObject*, double> coeffs;
+		for( long long k = begin; k < end; ++k )
+		{
+			long long index = indices.integer( k );
+			if( index < 0 || index >= varcount )
+			{
+				PyErr_Format( PyExc_IndexError, "variable index %lld out of range", index );
+				return 0;
+			}
+			coeffs[ varitems[ index ] ] += data.real( k );
+		}
+		cppy::ptr pyexpr( make_expression( coeffs, -rhs.real( row ) ) );
+		if( !pyexpr )
+			return 0;
+		PyObject* pycn = PyType_GenericNew( Constraint::TypeObject, 0, 0 );
+		if( !pycn )
+			return 0;
+		Constraint* cn = reinterpret_cast<Constraint*>( pycn );
+		cn->expression = pyexpr.release();
+		new( &cn->constraint ) kiwi::Constraint(
+			convert_to_kiwi_expression( cn->expression ), ops[ row ], strengths[ row ] );
+		PyList_SET_ITEM( pycns.get(), row, pycn );
+		constraints.push_back( cn->constraint );
+	}
+
+	PyObject* error = 0;
+	Py_ssize_t index = 0;
+	{
+		SolverGuard guard( self );
+		try
+		{
+			self->solver.addConstraints( constraints );
+		}
+		catch( const kiwi::UnsatisfiableConstraint& e )
+		{
+			error = UnsatisfiableConstraint;
+			index = find_constraint( constraints, e.constraint() );
+			assert( index >= 0 );
+		}
+	}
+	if( error )
+	{
+		PyErr_SetObject( error, PyList_GET_ITEM( pycns.get(), index ) );
+		return 0;
+	}
+	return pycns.release();
+}
+
+
 PyObject*
 Solver_removeConstraint( Solver* self, PyObject* other )
 {
 	if( !Constraint::TypeCheck( other ) )
 		return cppy::type_error( other, "Constraint" );
 	Constraint* cn = reinterpret_cast<Constraint*>( other );
-	try
+	PyObject* error = 0;
+	{
+		SolverGuard guard( self );
+		try
+		{
+			self->solver.removeConstraint( cn->constraint );
+		}
+		catch( const kiwi::UnknownConstraint& )
+		{
+			error = UnknownConstraint;
+		}
+	}
+	if( error )
+	{
+		PyErr_SetObject( error, other );
+		return 0;
+	}
+	Py_RETURN_NONE;
+}
+
+
+PyObject*
+Solver_removeConstraints( Solver* self, PyObject* arg )
+{
+	cppy::ptr items;
+	std::vector<kiwi::Constraint> constraints;
+	if( !collect_constraints( arg, items, constraints ) )
+		return 0;
+	PyObject* error = 0;
+	Py_ssize_t index = 0;
 	{
-		ACQUIRE_GLOBAL_LOCK();
-		self->solver.removeConstraint( cn->constraint );
-		RELEASE_GLOBAL_LOCK();
+		SolverGuard guard( self );
+		try
+		{
+			self->solver.removeConstraints( constraints );
+		}
+		catch( const kiwi::UnknownConstraint& e )
+		{
+			error = UnknownConstraint;
+			index = find_constraint( constraints, e.constraint() );
+			assert( index >= 0 );
+		}
 	}
-	catch( const kiwi::UnknownConstraint& )
+	if( error )
 	{
-		RELEASE_GLOBAL_LOCK();
-		PyErr_SetObject( UnknownConstraint, other );
+		PyErr_SetObject( error, PySequence_Fast_GET_ITEM( items.get(), index ) );
 		return 0;
 	}
 	Py_RETURN_NONE;
@@ -100,43 +519,97 @@ Solver_hasConstraint( Solver* self, PyObject* other )
 		return cppy::type_error( other, "Constraint" );
 	Constraint* cn = reinterpret_cast<Constraint*>( other );
 
-	ACQUIRE_GLOBAL_LOCK();
-	bool hasConstraint = self->solver.hasConstraint( cn->constraint );
-	RELEASE_GLOBAL_LOCK();
+	bool hasConstraint;
+	{
+		SolverGuard guard( self );
+		hasConstraint = self->solver.hasConstraint( cn->constraint );
+	}
 
 	return cppy::incref( hasConstraint ? Py_True : Py_False );
 }
 
 
 PyObject*
-Solver_addEditVariable( Solver* self, PyObject* args )
+Solver_addEditVariable( Solver* self, PyObject* const* args, Py_ssize_t nargs )
 {
-	PyObject* pyvar;
-	PyObject* pystrength;
-	if( !PyArg_ParseTuple( args, "OO", &pyvar, &pystrength ) )
+	if( !check_nargs( "addEditVariable", nargs, 2, 2 ) )
 		return 0;
+	PyObject* pyvar = args[ 0 ];
+	PyObject* pystrength = args[ 1 ];
 	if( !Variable::TypeCheck( pyvar ) )
 		return cppy::type_error( pyvar, "Variable" );
 	double strength;
 	if( !convert_to_strength( pystrength, strength ) )
 		return 0;
 	Variable* var = reinterpret_cast<Variable*>( pyvar );
-	try
+	PyObject* error = 0;
+	std::string message;
 	{
-		ACQUIRE_GLOBAL_LOCK();
-		self->solver.addEditVariable( var->variable, strength );
-		RELEASE_GLOBAL_LOCK();
+		SolverGuard guard( self );
+		try
+		{
+			self->solver.addEditVariable( var->variable, strength );
+		}
+		catch( const kiwi::DuplicateEditVariable& )
+		{
+			error = DuplicateEditVariable;
+		}
+		catch( const kiwi::BadRequiredStrength& e )
+		{
+			error = BadRequiredStrength;
+			message = e.what();
+		}
 	}
-	catch( const kiwi::DuplicateEditVariable& )
+	if( error == DuplicateEditVariable )
 	{
-		RELEASE_GLOBAL_LOCK();
 		PyErr_SetObject( DuplicateEditVariable, pyvar );
 		return 0;
 	}
-	catch( const kiwi::BadRequiredStrength& e )
+	if( error == BadRequiredStrength )
 	{
-		RELEASE_GLOBAL_LOCK();
-		PyErr_SetString( BadRequiredStrength, e.what() );
+		PyErr_SetString( BadRequiredStrength, message.c_str() );
+		return 0;
+	}
+	Py_RETURN_NONE;
+}
+
+
+PyObject*
+Solver_addEditVariables( Solver* self, PyObject* arg )
+{
+	std::vector<cppy::ptr> pyvars;
+	std::vector<std::pair<kiwi::Variable, double>> edits;
+	if( !collect_pairs( arg, convert_to_strength, pyvars, edits ) )
+		return 0;
+	PyObject* error = 0;
+	Py_ssize_t index = 0;
+	std::string message;
+	{
+		SolverGuard guard( self );
+		try
+		{
+			self->solver.addEditVariables( edits );
+		}
+		catch( const kiwi::DuplicateEditVariable& e )
+		{
+			error = DuplicateEditVariable;
+			index = find_variable( edits, e.variable() );
+			assert( index >= 0 );
+		}
+		catch( const kiwi::BadRequiredStrength& e )
+		{
+			error = BadRequiredStrength;
+			message = e.what();
+		}
+	}
+	if( error == DuplicateEditVariable )
+	{
+		PyErr_SetObject( DuplicateEditVariable, pyvars[ index ].get() );
+		return 0;
+	}
+	if( error == BadRequiredStrength )
+	{
+		PyErr_SetString( BadRequiredStrength, message.c_str() );
 		return 0;
 	}
 	Py_RETURN_NONE;
@@ -149,16 +622,21 @@ Solver_removeEditVariable( Solver* self, PyObject* other )
 	if( !Variable::TypeCheck( other ) )
 		return cppy::type_error( other, "Variable" );
 	Variable* var = reinterpret_cast<Variable*>( other );
-	try
+	PyObject* error = 0;
 	{
-		ACQUIRE_GLOBAL_LOCK();
-		self->solver.removeEditVariable( var->variable );
-		RELEASE_GLOBAL_LOCK();
+		SolverGuard guard( self );
+		try
+		{
+			self->solver.removeEditVariable( var->variable );
+		}
+		catch( const kiwi::UnknownEditVariable& )
+		{
+			error = UnknownEditVariable;
+		}
 	}
-	catch( const kiwi::UnknownEditVariable& )
+	if( error )
 	{
-		RELEASE_GLOBAL_LOCK();
-		PyErr_SetObject( UnknownEditVariable, other );
+		PyErr_SetObject( error, other );
 		return 0;
 	}
 	Py_RETURN_NONE;
@@ -171,36 +649,74 @@ Solver_hasEditVariable( Solver* self, PyObject* other )
 	if( !Variable::TypeCheck( other ) )
 		return cppy::type_error( other, "Variable" );
 	Variable* var = reinterpret_cast<Variable*>( other );
-	ACQUIRE_GLOBAL_LOCK();
-	bool hasEditVariable = self->solver.hasEditVariable( var->variable );
-	RELEASE_GLOBAL_LOCK();
+	bool hasEditVariable;
+	{
+		SolverGuard guard( self );
+		hasEditVariable = self->solver.hasEditVariable( var->variable );
+	}
 	return cppy::incref( hasEditVariable ? Py_True : Py_False );
 }
 
 
 PyObject*
-Solver_suggestValue( Solver* self, PyObject* args )
+Solver_suggestValue( Solver* self, PyObject* const* args, Py_ssize_t nargs )
 {
-	PyObject* pyvar;
-	PyObject* pyvalue;
-	if( !PyArg_ParseTuple( args, "OO", &pyvar, &pyvalue ) )
+	if( !check_nargs( "suggestValue", nargs, 2, 2 ) )
 		return 0;
+	PyObject* pyvar = args[ 0 ];
+	PyObject* pyvalue = args[ 1 ];
 	if( !Variable::TypeCheck( pyvar ) )
 		return cppy::type_error( pyvar, "Variable" );
 	double value;
 	if( !convert_to_double( pyvalue, value ) )
 		return 0;
 	Variable* var = reinterpret_cast<Variable*>( pyvar );
-	try
+	PyObject* error = 0;
+	{
+		SolverGuard guard( self );
+		try
+		{
+			self->solver.suggestValue( var->variable, value );
+		}
+		catch( const kiwi::UnknownEditVariable& )
+		{
+			error = UnknownEditVariable;
+		}
+	}
+	if( error )
+	{
+		PyErr_SetObject( error, pyvar );
+		return 0;
+	}
+	Py_RETURN_NONE;
+}
+
+
+PyObject*
+Solver_suggestValues( Solver* self, PyObject* arg )
+{
+	std::vector<cppy::ptr> pyvars;
+	std::vector<std::pair<kiwi::Variable, double>> suggestions;
+	if( !collect_pairs( arg, convert_to_double, pyvars, suggestions ) )
+		return 0;
+	PyObject* error = 0;
+	Py_ssize_t index = 0;
 	{
-		ACQUIRE_GLOBAL_LOCK();
-		self->solver.suggestValue( var->variable, value );
-		RELEASE_GLOBAL_LOCK();
+		SolverGuard guard( self );
+		try
+		{
+			self->solver.suggestValues( suggestions );
+		}
+		catch( const kiwi::UnknownEditVariable& e )
+		{
+			error = UnknownEditVariable;
+			index = find_variable( suggestions, e.variable() );
+			assert( index >= 0 );
+		}
 	}
-	catch( const kiwi::UnknownEditVariable& )
+	if( error )
 	{
-		RELEASE_GLOBAL_LOCK();
-		PyErr_SetObject( UnknownEditVariable, pyvar );
+		PyErr_SetObject( error, pyvars[ index ].get() );
 		return 0;
 	}
 	Py_RETURN_NONE;
@@ -210,9 +726,109 @@ Solver_suggestValue( Solver* self, PyObject* args )
 PyObject*
 Solver_updateVariables( Solver* self )
 {
-	ACQUIRE_GLOBAL_LOCK();
-	self->solver.updateVariables();
-	RELEASE_GLOBAL_LOCK();
+	{
+		SolverGuard guard( self );
+		self->solver.updateVariables();
+	}
+	Py_RETURN_NONE;
+}
+
+
+/* Test whether a buffer holds native doubles.
+
+*/
+bool
+is_double_buffer( const Py_buffer& view )
+{
+	if( view.itemsize != sizeof( double ) || !view.format )
+		return false;
+	std::string format( view.format );
+	return format == "d" || format == "@d" || format == "=d";
+}
+
+
+PyObject*
+Solver_values( Solver* self, PyObject* const* args, Py_ssize_t nargs )
+{
+	if( !check_nargs( "values", nargs, 1, 2 ) )
+		return 0;
+	PyObject* pyvars = args[ 0 ];
+	PyObject* out = nargs > 1 ? args[ 1 ] : Py_None;
+	cppy::ptr items( snapshot_sequence( pyvars, "expected a sequence of Variable" ) );
+	if( !items )
+		return 0;
+	Py_ssize_t size = PySequence_Fast_GET_SIZE( items.get() );
+	PyObject** objects = PySequence_Fast_ITEMS( items.get() );
+	std::vector<const kiwi::Variable*> variables( size );
+	for( Py_ssize_t i = 0; i < size; ++i )
+	{
+		if( !Variable::TypeCheck( objects[ i ] ) )
+			return cppy::type_error( objects[ i ], "Variable" );
+		// The variables are kept alive by the snapshot of the sequence.
+		variables[ i ] = &reinterpret_cast<Variable*>( objects[ i ] )->variable;
+	}
+
+	// Without an output buffer, the values are returned as a list.
+	if( out == Py_None )
+	{
+		std::vector<double> values( size );
+		{
+			SolverGuard guard( self );
+			for( Py_ssize_t i = 0; i < size; ++i )
+				values[ i ] = variables[ i ]->value();
+		}
+		cppy::ptr list( PyList_New( size ) );
+		if( !list )
+			return 0;
+		for( Py_ssize_t i = 0; i < size; ++i )
+		{
+			PyObject* value = PyFloat_FromDouble( values[ i ] );
+			if( !value )
+				return 0;
+			PyList_SET_ITEM( list.get(), i, value );
+		}
+		return list.release();
+	}
+
+	Py_buffer view;
+	if( PyObject_GetBuffer( out, &view, PyBUF_WRITABLE | PyBUF_FORMAT | PyBUF_C_CONTIGUOUS ) != 0 )
+		return 0;
+	if( !is_double_buffer( view ) || view.len != size * Py_ssize_t( sizeof( double ) ) )
+	{
+		PyBuffer_Release( &view );
+		PyErr_Format(
+			PyExc_ValueError,
+			"the output buffer must hold %zd contiguous doubles", size );
+		return 0;
+	}
+	double* data = static_cast<double*>( view.buf );
+	{
+		SolverGuard guard( self );
+		for( Py_ssize_t i = 0; i < size; ++i )
+			data[ i ] = variables[ i ]->value();
+	}
+	PyBuffer_Release( &view );
+	return cppy::incref( out );
+}
+
+
+PyObject*
+Solver_setGilThreshold( Solver* self, PyObject* value )
+{
+	if( !PyLong_Check( value ) )
+		return cppy::type_error( value, "int" );
+	Py_ssize_t rows = PyLong_AsSsize_t( value );
+	if( rows == -1 && PyErr_Occurred() )
+		return 0;
+	if( rows < 0 )
+	{
+		PyErr_SetString( PyExc_ValueError, "the threshold must be non-negative" );
+		return 0;
+	}
+	{
+		SolverGuard guard( self );
+		self->gil_threshold = static_cast<std::size_t>( rows );
+	}
 	Py_RETURN_NONE;
 }
 
@@ -220,9 +836,10 @@ Solver_updateVariables( Solver* self )
 PyObject*
 Solver_reset( Solver* self )
 {
-	ACQUIRE_GLOBAL_LOCK();
-	self->solver.reset();
-	RELEASE_GLOBAL_LOCK();
+	{
+		SolverGuard guard( self );
+		self->solver.reset();
+	}
 	Py_RETURN_NONE;
 }
 
@@ -230,9 +847,11 @@ Solver_reset( Solver* self )
 PyObject*
 Solver_dump( Solver* self )
 {
-	ACQUIRE_GLOBAL_LOCK();
-	std::string dumps = self->solver.dumps();
-	RELEASE_GLOBAL_LOCK();
+	std::string dumps;
+	{
+		SolverGuard guard( self );
+		dumps = self->solver.dumps();
+	}
 	cppy::ptr dump_str( PyUnicode_FromString( dumps.c_str() ) );
 	PyObject_Print( dump_str.get(), stdout, 0 );
 	Py_RETURN_NONE;
@@ -241,9 +860,11 @@ Solver_dump( Solver* self )
 PyObject*
 Solver_dumps( Solver* self )
 {
-	ACQUIRE_GLOBAL_LOCK();
-	std::string dumps = self->solver.dumps();
-	RELEASE_GLOBAL_LOCK();
+	std::string dumps;
+	{
+		SolverGuard guard( self );
+		dumps = self->solver.dumps();
+	}
 	return PyUnicode_FromString( dumps.c_str() );
 }
 
@@ -251,20 +872,34 @@ static PyMethodDef
 Solver_methods[] = {
 	{ "addConstraint", ( PyCFunction )Solver_addConstraint, METH_O,
 	  "Add a constraint to the solver." },
+	{ "addConstraints", ( PyCFunction )Solver_addConstraints, METH_O,
+	  "Add a sequence of constraints to the solver." },
+	{ "addLinearConstraints", ( PyCFunction )Solver_addLinearConstraints, METH_VARARGS | METH_KEYWORDS,
+	  "Create and add the constraints of the rows of a sparse matrix." },
 	{ "removeConstraint", ( PyCFunction )Solver_removeConstraint, METH_O,
 	  "Remove a constraint from the solver." },
+	{ "removeConstraints", ( PyCFunction )Solver_removeConstraints, METH_O,
+	  "Remove a sequence of constraints from the solver." },
 	{ "hasConstraint", ( PyCFunction )Solver_hasConstraint, METH_O,
 	  "Check whether the solver contains a constraint." },
-	{ "addEditVariable", ( PyCFunction )Solver_addEditVariable, METH_VARARGS,
+	{ "addEditVariable", ( PyCFunction )Solver_addEditVariable, METH_FASTCALL,
 	  "Add an edit variable to the solver." },
+	{ "addEditVariables", ( PyCFunction )Solver_addEditVariables, METH_O,
+	  "Add a sequence of (variable, strength) pairs as edit variables." },
 	{ "removeEditVariable", ( PyCFunction )Solver_removeEditVariable, METH_O,
 	  "Remove an edit variable from the solver." },
 	{ "hasEditVariable", ( PyCFunction )Solver_hasEditVariable, METH_O,
 	  "Check whether the solver contains an edit variable." },
-	{ "suggestValue", ( PyCFunction )Solver_suggestValue, METH_VARARGS,
+	{ "suggestValue", ( PyCFunction )Solver_suggestValue, METH_FASTCALL,
 	  "Suggest a desired value for an edit variable." },
+	{ "suggestValues", ( PyCFunction )Solver_suggestValues, METH_O,
+	  "Suggest values from a sequence of (variable, value) pairs." },
 	{ "updateVariables", ( PyCFunction )Solver_updateVariables, METH_NOARGS,
 	  "Update the values of the solver variables." },
+	{ "values", ( PyCFunction )Solver_values, METH_FASTCALL,
+	  "Read the values of a sequence of variables, into a buffer of doubles if given." },
+	{ "setGilThreshold", ( PyCFunction )Solver_setGilThreshold, METH_O,
+	  "Set the number of tableau rows above which the GIL is released." },
 	{ "reset", ( PyCFunction )Solver_reset, METH_NOARGS,
 	  "Reset the solver to the initial empty starting condition." },
 	{ "dump", ( PyCFunction )Solver_dump, METH_NOARGS,
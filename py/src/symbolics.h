@@ -75,6 +75,30 @@ struct BinaryInvoke
 };
 
 
+/* Copy the items of an expression into a new one, with new references.
+
+*/
+inline void
+copy_items( Expression* source, Expression* target, Py_ssize_t offset, double factor = 1.0 )
+{
+	Py_ssize_t size = Py_SIZE( source );
+	for( Py_ssize_t i = 0; i < size; ++i )
+	{
+		Expression::Item& item = target->items[ offset + i ];
+		item.variable = cppy::incref( source->items[ i ].variable );
+		item.coefficient = source->items[ i ].coefficient * factor;
+	}
+}
+
+
+inline void
+set_item( Expression* target, Py_ssize_t index, PyObject* variable, double coefficient )
+{
+	target->items[ index ].variable = cppy::incref( variable );
+	target->items[ index ].coefficient = coefficient;
+}
+
+
 struct BinaryMul
 {
 	template<typename T, typename U>
@@ -114,27 +138,11 @@ PyObject* BinaryMul::operator()( Term* first, double second )
 template<> inline
 PyObject* BinaryMul::operator()( Expression* first, double second )
 {
-	cppy::ptr pyexpr( PyType_GenericNew( Expression::TypeObject, 0, 0 ) );
-	if( !pyexpr )
+	Expression* expr = new_expression( Py_SIZE( first ), first->constant * second );
+	if( !expr )
 		return 0;
-	Expression* expr = reinterpret_cast<Expression*>( pyexpr.get() );
-	cppy::ptr terms( PyTuple_New( PyTuple_GET_SIZE( first->terms ) ) );
-	if( !terms )
-		return 0;
-	Py_ssize_t end = PyTuple_GET_SIZE( first->terms );
-	for( Py_ssize_t i = 0; i < end; ++i )  // memset 0 for safe error return
-		PyTuple_SET_ITEM( terms.get(), i, 0 );
-	for( Py_ssize_t i = 0; i < end; ++i )
-	{
-		PyObject* item = PyTuple_GET_ITEM( first->terms, i );
-		PyObject* term = BinaryMul()( reinterpret_cast<Term*>( item ), second );
-		if( !term )
-			return 0;
-		PyTuple_SET_ITEM( terms.get(), i, term );
-	}
-	expr->terms = terms.release();
-	expr->constant = first->constant * second;
-	return pyexpr.release();
+	copy_items( first, expr, 0, second );
+	return pyobject_cast( expr );
 }
 
 
@@ -249,76 +257,59 @@ struct BinaryAdd
 template<> inline
 PyObject* BinaryAdd::operator()( Expression* first, Expression* second )
 {
-	cppy::ptr pyexpr( PyType_GenericNew( Expression::TypeObject, 0, 0 ) );
-	if( !pyexpr )
+	Expression* expr = new_expression(
+		Py_SIZE( first ) + Py_SIZE( second ), first->constant + second->constant );
+	if( !expr )
 		return 0;
-	Expression* expr = reinterpret_cast<Expression*>( pyexpr.get() );
-	expr->constant = first->constant + second->constant;
-	expr->terms = PySequence_Concat( first->terms, second->terms );
-	if( !expr->terms )
-		return 0;
-	return pyexpr.release();
+	copy_items( first, expr, 0 );
+	copy_items( second, expr, Py_SIZE( first ) );
+	return pyobject_cast( expr );
 }
 
 
 template<> inline
 PyObject* BinaryAdd::operator()( Expression* first, Term* second )
 {
-	cppy::ptr pyexpr( PyType_GenericNew( Expression::TypeObject, 0, 0 ) );
-	if( !pyexpr )
+	Expression* expr = new_expression( Py_SIZE( first ) + 1, first->constant );
+	if( !expr )
 		return 0;
-	PyObject* terms = PyTuple_New( PyTuple_GET_SIZE( first->terms ) + 1 );
-	if( !terms )
-		return 0;
-	Py_ssize_t end = PyTuple_GET_SIZE( first->terms );
-	for( Py_ssize_t i = 0; i < end; ++i )
-	{
-		PyObject* item = PyTuple_GET_ITEM( first->terms, i );
-		PyTuple_SET_ITEM( terms, i, cppy::incref( item ) );
-	}
-	PyTuple_SET_ITEM( terms, end, cppy::incref( pyobject_cast( second ) ) );
-	Expression* expr = reinterpret_cast<Expression*>( pyexpr.get() );
-	expr->terms = terms;
-	expr->constant = first->constant;
-	return pyexpr.release();
+	copy_items( first, expr, 0 );
+	set_item( expr, Py_SIZE( first ), second->variable, second->coefficient );
+	return pyobject_cast( expr );
 }
 
 
 template<> inline
 PyObject* BinaryAdd::operator()( Expression* first, Variable* second )
 {
-	cppy::ptr temp( BinaryMul()( second, 1.0 ) );
-	if( !temp )
+	Expression* expr = new_expression( Py_SIZE( first ) + 1, first->constant );
+	if( !expr )
 		return 0;
-	return operator()( first, reinterpret_cast<Term*>( temp.get() ) );
+	copy_items( first, expr, 0 );
+	set_item( expr, Py_SIZE( first ), pyobject_cast( second ), 1.0 );
+	return pyobject_cast( expr );
 }
 
 
 template<> inline
 PyObject* BinaryAdd::operator()( Expression* first, double second )
 {
-	cppy::ptr pyexpr( PyType_GenericNew( Expression::TypeObject, 0, 0 ) );
-	if( !pyexpr )
+	Expression* expr = new_expression( Py_SIZE( first ), first->constant + second );
+	if( !expr )
 		return 0;
-	Expression* expr = reinterpret_cast<Expression*>( pyexpr.get() );
-	expr->terms = cppy::incref( first->terms );
-	expr->constant = first->constant + second;
-	return pyexpr.release();
+	copy_items( first, expr, 0 );
+	return pyobject_cast( expr );
 }
 
 
 template<> inline
 PyObject* BinaryAdd::operator()( Term* first, double second )
 {
-	cppy::ptr pyexpr( PyType_GenericNew( Expression::TypeObject, 0, 0 ) );
-	if( !pyexpr )
-		return 0;
-	Expression* expr = reinterpret_cast<Expression*>( pyexpr.get() );
-	expr->constant = second;
-	expr->terms = PyTuple_Pack( 1, first );
-	if( !expr->terms )
+	Expression* expr = new_expression( 1, second );
+	if( !expr )
 		return 0;
-	return pyexpr.release();
+	set_item( expr, 0, first->variable, first->coefficient );
+	return pyobject_cast( expr );
 }
 
 
@@ -332,65 +323,66 @@ PyObject* BinaryAdd::operator()( Term* first, Expression* second )
 template<> inline
 PyObject* BinaryAdd::operator()( Term* first, Term* second )
 {
-	cppy::ptr pyexpr( PyType_GenericNew( Expression::TypeObject, 0, 0 ) );
-	if( !pyexpr )
-		return 0;
-	Expression* expr = reinterpret_cast<Expression*>( pyexpr.get() );
-	expr->constant = 0.0;
-	expr->terms = PyTuple_Pack( 2, first, second );
-	if( !expr->terms )
+	Expression* expr = new_expression( 2, 0.0 );
+	if( !expr )
 		return 0;
-	return pyexpr.release();
+	set_item( expr, 0, first->variable, first->coefficient );
+	set_item( expr, 1, second->variable, second->coefficient );
+	return pyobject_cast( expr );
 }
 
 
 template<> inline
 PyObject* BinaryAdd::operator()( Term* first, Variable* second )
 {
-	cppy::ptr temp( BinaryMul()( second, 1.0 ) );
-	if( !temp )
+	Expression* expr = new_expression( 2, 0.0 );
+	if( !expr )
 		return 0;
-	return BinaryAdd()( first, reinterpret_cast<Term*>( temp.get() ) );
+	set_item( expr, 0, first->variable, first->coefficient );
+	set_item( expr, 1, pyobject_cast( second ), 1.0 );
+	return pyobject_cast( expr );
 }
 
 
 template<> inline
 PyObject* BinaryAdd::operator()( Variable* first, double second )
 {
-	cppy::ptr temp( BinaryMul()( first, 1.0 ) );
-	if( !temp )
+	Expression* expr = new_expression( 1, second );
+	if( !expr )
 		return 0;
-	return operator()( reinterpret_cast<Term*>( temp.get() ), second );
+	set_item( expr, 0, pyobject_cast( first ), 1.0 );
+	return pyobject_cast( expr );
 }
 
 
 template<> inline
 PyObject* BinaryAdd::operator()( Variable* first, Variable* second )
 {
-	cppy::ptr temp( BinaryMul()( first, 1.0 ) );
-	if( !temp )
+	Expression* expr = new_expression( 2, 0.0 );
+	if( !expr )
 		return 0;
-	return operator()( reinterpret_cast<Term*>( temp.get() ), second );
+	set_item( expr, 0, pyobject_cast( first ), 1.0 );
+	set_item( expr, 1, pyobject_cast( second ), 1.0 );
+	return pyobject_cast( expr );
 }
 
 
 template<> inline
 PyObject* BinaryAdd::operator()( Variable* first, Term* second )
 {
-	cppy::ptr temp( BinaryMul()( first, 1.0 ) );
-	if( !temp )
+	Expression* expr = new_expression( 2, 0.0 );
+	if( !expr )
 		return 0;
-	return operator()( reinterpret_cast<Term*>( temp.get() ), second );
+	set_item( expr, 0, pyobject_cast( first ), 1.0 );
+	set_item( expr, 1, second->variable, second->coefficient );
+	return pyobject_cast( expr );
 }
 
 
 template<> inline
 PyObject* BinaryAdd::operator()( Variable* first, Expression* second )
 {
-	cppy::ptr temp( BinaryMul()( first, 1.0 ) );
-	if( !temp )
-		return 0;
-	return operator()( reinterpret_cast<Term*>( temp.get() ), second );
+	return operator()( second, first );
 }
 
 
@@ -579,10 +571,8 @@ PyObject* makecn( T first, U second, kiwi::RelationalOperator op )
 	cn->expression = reduce_expression( pyexpr.get() );
 	if( !cn->expression )
 		return 0;
-	ACQUIRE_GLOBAL_LOCK();
 	kiwi::Expression expr( convert_to_kiwi_expression( cn->expression ) );
 	new( &cn->constraint ) kiwi::Constraint( expr, op, kiwi::strength::required );
-	RELEASE_GLOBAL_LOCK();
 	return pycn.release();
 }
 
@@ -7,6 +7,7 @@
 |----------------------------------------------------------------------------*/
 #include <cppy/cppy.h>
 #include <sstream>
+#include "freelist.h"
 #include "symbolics.h"
 #include "types.h"
 #include "util.h"
@@ -78,9 +79,7 @@ Term_repr( Term* self )
 {
 	std::stringstream stream;
 	stream << self->coefficient << " * ";
-	ACQUIRE_GLOBAL_LOCK();
-	std::string name = reinterpret_cast<Variable*>( self->variable )->variable.name();
-	RELEASE_GLOBAL_LOCK();
+	std::string name = variable_name( self->variable );
 	stream << name;
 	return PyUnicode_FromString( stream.str().c_str() );
 }
@@ -104,9 +103,7 @@ PyObject*
 Term_value( Term* self )
 {
 	Variable* pyvar = reinterpret_cast<Variable*>( self->variable );
-	ACQUIRE_GLOBAL_LOCK();
 	double value = pyvar->variable.value();
-	RELEASE_GLOBAL_LOCK();
 	return PyFloat_FromDouble( self->coefficient * value );
 }
 
@@ -192,8 +189,8 @@ static PyType_Slot Term_Type_slots[] = {
     { Py_tp_richcompare, void_cast( Term_richcmp ) },  /* tp_richcompare */
     { Py_tp_methods, void_cast( Term_methods ) },      /* tp_methods */
     { Py_tp_new, void_cast( Term_new ) },              /* tp_new */
-    { Py_tp_alloc, void_cast( PyType_GenericAlloc ) }, /* tp_alloc */
-    { Py_tp_free, void_cast( PyObject_GC_Del ) },      /* tp_free */
+    { Py_tp_alloc, void_cast( FreeList<Term>::alloc ) }, /* tp_alloc */
+    { Py_tp_free, void_cast( FreeList<Term>::free ) },   /* tp_free */
     { Py_nb_add, void_cast( Term_add ) },              /* nb_add */
     { Py_nb_subtract, void_cast( Term_sub ) },         /* nb_subatract */
     { Py_nb_multiply, void_cast( Term_mul ) },         /* nb_multiply */
@@ -7,8 +7,18 @@
 |----------------------------------------------------------------------------*/
 #pragma once
 #include <Python.h>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
 #include <kiwi/kiwi.h>
 
+// On free-threaded builds the kiwi objects are shared by threads running
+// at once, so the reference counts must be atomic.
+#if defined(Py_GIL_DISABLED) && !defined(KIWI_ATOMIC_REFCOUNT)
+#error "free-threaded builds of the extension need KIWI_ATOMIC_REFCOUNT"
+#endif
+
 
 namespace kiwisolver
 {
@@ -76,10 +86,52 @@ struct Term
 };
 
 
+/* An immutable sum of terms and a constant.
+
+The terms are stored inline after the object header, each holding a new
+reference to its variable. The tuple of Term objects returned by `terms`
+is the one given to the constructor, or is made on first access, and is
+then kept with the expression. A variable-size type cannot give weakref
+support to its subclasses, so the list of weak references is kept here.
+
+*/
 struct Expression
 {
-	PyObject_HEAD
+	struct Item
+	{
+		PyObject* variable;
+		double coefficient;
+	};
+
+	PyObject_VAR_HEAD
+	double constant;
 	PyObject* terms;
+	PyObject* weakreflist;
+	Item items[ 1 ];
+
+    static PyType_Spec TypeObject_Spec;
+
+    static PyTypeObject* TypeObject;
+
+	static bool Ready();
+
+	static bool TypeCheck( PyObject* obj )
+	{
+		return PyObject_TypeCheck( obj, TypeObject ) != 0;
+	}
+};
+
+
+/* A mutable sum of terms, for building long expressions in place.
+
+Each term holds a new reference to its variable. The terms are reduced
+when an Expression or a Constraint is made from the sum.
+
+*/
+struct LinearExpression
+{
+	PyObject_HEAD
+	std::vector<std::pair<PyObject*, double>> terms;
 	double constant;
 
     static PyType_Spec TypeObject_Spec;
@@ -118,6 +170,8 @@ struct Solver
 {
 	PyObject_HEAD
 	kiwi::Solver solver;
+	std::mutex mutex;
+	std::size_t gil_threshold;
 
     static PyType_Spec TypeObject_Spec;
 
@@ -135,4 +189,7 @@ struct Solver
 bool init_exceptions();
 
 
+PyObject* new_capi_capsule();
+
+
 }  // namespace kiwisolver
@@ -8,8 +8,9 @@
 #pragma once
 #include <cppy/cppy.h>
 #include <map>
-#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 #include <kiwi/kiwi.h>
 #include "types.h"
 
@@ -17,20 +18,152 @@
 namespace kiwisolver
 {
 
-#ifdef Py_GIL_DISABLED
-extern std::recursive_mutex global_lock;
-#define ACQUIRE_GLOBAL_LOCK() global_lock.lock()
-#define RELEASE_GLOBAL_LOCK() global_lock.unlock()
-#else
-#define ACQUIRE_GLOBAL_LOCK()
-#define RELEASE_GLOBAL_LOCK()
-#endif
+/*
+Implementation note
+===================
+Each solver is protected by its own mutex, so threads driving different
+solvers do not contend. Large solvers release the GIL while they pivot,
+which is when no kiwi object is copied or destroyed, so the reference
+counts shared with the other threads need not be atomic on GIL builds.
+On free-threaded builds the kiwi objects are used by several threads at
+once, and the extension is built with KIWI_ATOMIC_REFCOUNT. The name of a
+variable is protected by a critical section on the Python variable on
+free-threaded builds. The other kiwi data is immutable once built, except
+for the values of the variables, which are written by the solvers holding
+them.
+*/
 
 #ifndef Py_BEGIN_CRITICAL_SECTION
 #define Py_BEGIN_CRITICAL_SECTION(op) {
 #define Py_END_CRITICAL_SECTION() }
 #endif
 
+/* Release the GIL while a solver pivots.
+
+*/
+class GilRelease : public kiwi::PivotLock
+{
+
+public:
+
+    GilRelease() : m_state( 0 ) {}
+
+    void unlock() override
+    {
+        m_state = PyEval_SaveThread();
+    }
+
+    void lock() override
+    {
+        PyEval_RestoreThread( m_state );
+        m_state = 0;
+    }
+
+private:
+
+    PyThreadState* m_state;
+};
+
+
+/* Hold the lock of a solver for the duration of an operation.
+
+The lock is waited for without the GIL. If the tableau holds at least the
+GIL threshold rows, the GIL is also released while the solver pivots. The
+operation itself runs with the GIL, so it may use the Python API.
+
+*/
+class SolverGuard
+{
+
+public:
+
+    SolverGuard( Solver* self ) : m_self( self )
+    {
+        if( !self->mutex.try_lock() )
+        {
+            Py_BEGIN_ALLOW_THREADS
+            self->mutex.lock();
+            Py_END_ALLOW_THREADS
+        }
+        if( self->gil_threshold != 0 && self->solver.rowCount() >= self->gil_threshold )
+            self->solver.setPivotLock( &m_release );
+    }
+
+    ~SolverGuard()
+    {
+        m_self->solver.setPivotLock( 0 );
+        m_self->mutex.unlock();
+    }
+
+private:
+
+    SolverGuard( const SolverGuard& );
+
+    SolverGuard& operator=( const SolverGuard& );
+
+    Solver* m_self;
+    GilRelease m_release;
+};
+
+
+/* Find the index of a constraint in a batch, or -1 if it is not there.
+
+The constraint of an error raised by a batch operation of the solver is
+always one of the batch.
+
+*/
+inline Py_ssize_t
+find_constraint( const std::vector<kiwi::Constraint>& items, const kiwi::Constraint& constraint )
+{
+    Py_ssize_t count = static_cast<Py_ssize_t>( items.size() );
+    for( Py_ssize_t i = 0; i < count; ++i )
+    {
+        if( items[ i ] == constraint )
+            return i;
+    }
+    return -1;
+}
+
+
+/* Find the index of a variable in a batch of pairs, or -1 if it is not there.
+
+*/
+inline Py_ssize_t
+find_variable( const std::vector<std::pair<kiwi::Variable, double>>& items, const kiwi::Variable& variable )
+{
+    Py_ssize_t count = static_cast<Py_ssize_t>( items.size() );
+    for( Py_ssize_t i = 0; i < count; ++i )
+    {
+        if( items[ i ].first.equals( variable ) )
+            return i;
+    }
+    return -1;
+}
+
+
+/* Check the number of arguments of a METH_FASTCALL method.
+
+*/
+inline bool
+check_nargs( const char* name, Py_ssize_t nargs, Py_ssize_t min, Py_ssize_t max )
+{
+    if( nargs >= min && nargs <= max )
+        return true;
+    const char* bound = min == max ? "" : nargs < min ? "at least " : "at most ";
+    Py_ssize_t expected = nargs < min ? min : max;
+    PyErr_Format(
+        PyExc_TypeError,
+        "%s() takes %s%zd argument%s (%zd given)",
+        name,
+        bound,
+        expected,
+        expected == 1 ? "" : "s",
+        nargs
+    );
+    return false;
+}
+
+
 inline bool
 convert_to_double( PyObject* obj, double& out )
 {
@@ -123,30 +256,39 @@ convert_to_relational_op( PyObject* value, kiwi::RelationalOperator& out )
 }
 
 
+/* Make an exact Expression with room for `size` items.
+
+The items are zeroed, so the expression can be released before they are
+all set. Each item which is set must hold a new reference to its variable.
+
+*/
+inline Expression*
+new_expression( Py_ssize_t size, double constant )
+{
+    PyTypeObject* type = Expression::TypeObject;
+    PyObject* pyexpr = type->tp_alloc( type, size );
+    if( !pyexpr )
+        return 0;
+    Expression* expr = reinterpret_cast<Expression*>( pyexpr );
+    expr->constant = constant;
+    return expr;
+}
+
+
 inline PyObject*
-make_terms( const std::map<PyObject*, double>& coeffs )
+make_expression( const std::map<PyObject*, double>& coeffs, double constant )
 {
-    typedef std::map<PyObject*, double>::const_iterator iter_t;
-    cppy::ptr terms( PyTuple_New( coeffs.size() ) );
-    if( !terms )
+    Expression* expr = new_expression( coeffs.size(), constant );
+    if( !expr )
         return 0;
-    Py_ssize_t size = PyTuple_GET_SIZE( terms.get() );
-    for( Py_ssize_t i = 0; i < size; ++i ) // zero tuple for safe early return
-        PyTuple_SET_ITEM( terms.get(), i, 0 );
-    Py_ssize_t i = 0;
-    iter_t it = coeffs.begin();
-    iter_t end = coeffs.end();
-    for( ; it != end; ++it, ++i )
+    Expression::Item* item = expr->items;
+    for( const auto& coeff : coeffs )
     {
-        PyObject* pyterm = PyType_GenericNew( Term::TypeObject, 0, 0 );
-        if( !pyterm )
-            return 0;
-        Term* term = reinterpret_cast<Term*>( pyterm );
-        term->variable = cppy::incref( it->first );
-        term->coefficient = it->second;
-        PyTuple_SET_ITEM( terms.get(), i, pyterm );
+        item->variable = cppy::incref( coeff.first );
+        item->coefficient = coeff.second;
+        ++item;
     }
-    return terms.release();
+    return pyobject_cast( expr );
 }
 
 
@@ -155,23 +297,10 @@ reduce_expression( PyObject* pyexpr )  // pyexpr must be an Expression
 {
     Expression* expr = reinterpret_cast<Expression*>( pyexpr );
     std::map<PyObject*, double> coeffs;
-    Py_ssize_t size = PyTuple_GET_SIZE( expr->terms );
+    Py_ssize_t size = Py_SIZE( expr );
     for( Py_ssize_t i = 0; i < size; ++i )
-    {
-        PyObject* item = PyTuple_GET_ITEM( expr->terms, i );
-        Term* term = reinterpret_cast<Term*>( item );
-        coeffs[ term->variable ] += term->coefficient;
-    }
-    cppy::ptr terms( make_terms( coeffs ) );
-    if( !terms )
-        return 0;
-    PyObject* pynewexpr = PyType_GenericNew( Expression::TypeObject, 0, 0 );
-    if( !pynewexpr )
-        return 0;
-    Expression* newexpr = reinterpret_cast<Expression*>( pynewexpr );
-    newexpr->terms = terms.release();
-    newexpr->constant = expr->constant;
-    return pynewexpr;
+        coeffs[ expr->items[ i ].variable ] += expr->items[ i ].coefficient;
+    return make_expression( coeffs, expr->constant );
 }
 
 
@@ -180,21 +309,26 @@ convert_to_kiwi_expression( PyObject* pyexpr )  // pyexpr must be an Expression
 {
     Expression* expr = reinterpret_cast<Expression*>( pyexpr );
     std::vector<kiwi::Term> kterms;
-    Py_ssize_t size = PyTuple_GET_SIZE( expr->terms );
+    Py_ssize_t size = Py_SIZE( expr );
+    kterms.reserve( size );
     for( Py_ssize_t i = 0; i < size; ++i )
     {
-        PyObject* item = PyTuple_GET_ITEM( expr->terms, i );
-        Term* term = reinterpret_cast<Term*>( item );
-        Variable* var = reinterpret_cast<Variable*>( term->variable );
-        ACQUIRE_GLOBAL_LOCK();
-        kiwi::Term t( var->variable, term->coefficient );
-        RELEASE_GLOBAL_LOCK();
-        kterms.push_back( t );
+        const Expression::Item& item = expr->items[ i ];
+        Variable* var = reinterpret_cast<Variable*>( item.variable );
+        kterms.push_back( kiwi::Term( var->variable, item.coefficient ) );
     }
-    ACQUIRE_GLOBAL_LOCK();
-    kiwi::Expression expression( kterms, expr->constant );
-    RELEASE_GLOBAL_LOCK();
-    return expression;
+    return kiwi::Expression( kterms, expr->constant );
+}
+
+
+inline std::string
+variable_name( PyObject* pyvar )  // pyvar must be a Variable
+{
+    std::string name;
+    Py_BEGIN_CRITICAL_SECTION( pyvar );
+    name = reinterpret_cast<Variable*>( pyvar )->variable.name();
+    Py_END_CRITICAL_SECTION();
+    return name;
 }
 
 
@@ -20,24 +20,36 @@ namespace
 {
 
 
-PyObject*
-Variable_new( PyTypeObject* type, PyObject* args, PyObject* kwargs )
+/* Stop tracking a variable which has no context.
+
+The context is the only object an exact variable refers to, so without
+one the variable cannot be part of a reference cycle, and the collector
+does not need to visit it. Setting a context tracks the variable again.
+Instances of subclasses may refer to other objects through their dict or
+slots, so they stay tracked.
+
+*/
+void
+untrack_without_context( Variable* self )
 {
-	static const char *kwlist[] = { "name", "context", 0 };
-	PyObject* context = 0;
-	PyObject* name = 0;
+#if !defined(PYPY_VERSION)
+	if( !self->context && Py_TYPE( self ) == Variable::TypeObject &&
+		PyObject_GC_IsTracked( pyobject_cast( self ) ) )
+		PyObject_GC_UnTrack( self );
+#endif
+}
 
-	if( !PyArg_ParseTupleAndKeywords(
-		args, kwargs, "|OO:__new__", const_cast<char**>( kwlist ),
-		&name, &context ) )
-		return 0;
 
-	cppy::ptr pyvar( PyType_GenericNew( type, args, kwargs ) );
+PyObject*
+make_variable( PyTypeObject* type, PyObject* name, PyObject* context )
+{
+	cppy::ptr pyvar( PyType_GenericNew( type, 0, 0 ) );
 	if( !pyvar )
 		return 0;
 
 	Variable* self = reinterpret_cast<Variable*>( pyvar.get() );
 	self->context = cppy::xincref( context );
+	untrack_without_context( self );
 
 	if( name != 0 )
 	{
@@ -46,21 +58,70 @@ Variable_new( PyTypeObject* type, PyObject* args, PyObject* kwargs )
 		std::string c_name;
 		if( !convert_pystr_to_str(name, c_name) )
 			return 0;  // LCOV_EXCL_LINE
-		ACQUIRE_GLOBAL_LOCK();
 		new( &self->variable ) kiwi::Variable( c_name );
-		RELEASE_GLOBAL_LOCK();
 	}
 	else
 	{
-		ACQUIRE_GLOBAL_LOCK();
 		new( &self->variable ) kiwi::Variable();
-		RELEASE_GLOBAL_LOCK();
 	}
 
 	return pyvar.release();
 }
 
 
+PyObject*
+Variable_new( PyTypeObject* type, PyObject* args, PyObject* kwargs )
+{
+	static const char *kwlist[] = { "name", "context", 0 };
+	PyObject* context = 0;
+	PyObject* name = 0;
+
+	if( !PyArg_ParseTupleAndKeywords(
+		args, kwargs, "|OO:__new__", const_cast<char**>( kwlist ),
+		&name, &context ) )
+		return 0;
+
+	return make_variable( type, name, context );
+}
+
+
+/* Create a variable without packing the arguments in a tuple.
+
+Calls with keywords go through Variable_new, which reports the errors.
+
+*/
+PyObject*
+Variable_vectorcall( PyObject* type, PyObject* const* args, size_t nargsf, PyObject* kwnames )
+{
+	Py_ssize_t nargs = PyVectorcall_NARGS( nargsf );
+	if( kwnames || nargs > 2 )
+	{
+		cppy::ptr pyargs( PyTuple_New( nargs ) );
+		if( !pyargs )
+			return 0;
+		for( Py_ssize_t i = 0; i < nargs; ++i )
+			PyTuple_SET_ITEM( pyargs.get(), i, cppy::incref( args[ i ] ) );
+		cppy::ptr pykwargs;
+		if( kwnames )
+		{
+			pykwargs = PyDict_New();
+			if( !pykwargs )
+				return 0;
+			Py_ssize_t nkwargs = PyTuple_GET_SIZE( kwnames );
+			for( Py_ssize_t i = 0; i < nkwargs; ++i )
+			{
+				PyObject* key = PyTuple_GET_ITEM( kwnames, i );
+				if( PyDict_SetItem( pykwargs.get(), key, args[ nargs + i ] ) < 0 )
+					return 0;
+			}
+		}
+		return Variable_new( pytype_cast( type ), pyargs.get(), pykwargs.get() );
+	}
+	return make_variable(
+		pytype_cast( type ), nargs > 0 ? args[ 0 ] : 0, nargs > 1 ? args[ 1 ] : 0 );
+}
+
+
 void
 Variable_clear( Variable* self )
 {
@@ -85,9 +146,7 @@ Variable_dealloc( Variable* self )
 {
 	PyObject_GC_UnTrack( self );
 	Variable_clear( self );
-	ACQUIRE_GLOBAL_LOCK();
 	self->variable.~Variable();
-	RELEASE_GLOBAL_LOCK();
 	Py_TYPE( self )->tp_free( pyobject_cast( self ) );
 }
 
@@ -95,9 +154,7 @@ Variable_dealloc( Variable* self )
 PyObject*
 Variable_repr( Variable* self )
 {
-	ACQUIRE_GLOBAL_LOCK();
-	std::string name = self->variable.name();
-	RELEASE_GLOBAL_LOCK();
+	std::string name = variable_name( pyobject_cast( self ) );
 	return PyUnicode_FromString( name.c_str() );
 }
 
@@ -105,9 +162,7 @@ Variable_repr( Variable* self )
 PyObject*
 Variable_name( Variable* self )
 {
-	ACQUIRE_GLOBAL_LOCK();
-	std::string name = self->variable.name();
-	RELEASE_GLOBAL_LOCK();
+	std::string name = variable_name( pyobject_cast( self ) );
 	return PyUnicode_FromString( name.c_str() );
 }
 
@@ -121,9 +176,9 @@ Variable_setName( Variable* self, PyObject* pystr )
    if( !convert_pystr_to_str( pystr, str ) )
        return 0;
 
-	ACQUIRE_GLOBAL_LOCK();
+	Py_BEGIN_CRITICAL_SECTION( self );
 	self->variable.setName( str );
-	RELEASE_GLOBAL_LOCK();
+	Py_END_CRITICAL_SECTION();
 
 	Py_RETURN_NONE;
 }
@@ -156,6 +211,10 @@ Variable_setContext_locked( Variable* self, PyObject* value )
 	{
 		Py_XSETREF(self->context, cppy::incref( value ));
 	}
+#if !defined(PYPY_VERSION)
+	if( !PyObject_GC_IsTracked( pyobject_cast( self ) ) )
+		PyObject_GC_Track( self );
+#endif
 }
 
 
@@ -172,9 +231,7 @@ Variable_setContext( Variable* self, PyObject* value )
 PyObject*
 Variable_value( Variable* self )
 {
-	ACQUIRE_GLOBAL_LOCK();
 	double value = self->variable.value();
-	RELEASE_GLOBAL_LOCK();
 	return PyFloat_FromDouble( value );
 }
 
@@ -301,6 +358,10 @@ bool Variable::Ready()
     {
         return false;
     }
+#if !defined(PYPY_VERSION)
+    // Not inherited, so subclasses go through tp_new and tp_init.
+    TypeObject->tp_vectorcall = Variable_vectorcall;
+#endif
     return true;
 }
 
@@ -0,0 +1,201 @@
+/*-----------------------------------------------------------------------------
+| Copyright (c) 2026, Nucleic Development Team.
+|
+| Distributed under the terms of the Modified BSD License.
+|
+| The full license is in the file LICENSE, distributed with this software.
+|----------------------------------------------------------------------------*/
+// An extension driving kiwisolver through its C API, built by test_capi.py.
+#include <Python.h>
+#include <vector>
+#include <kiwi/kiwi.h>
+#include <kiwisolver/capi.h>
+
+
+namespace
+{
+
+const KiwiSolver_CAPI* api = 0;
+
+
+/* Collect the objects of a sequence, borrowed from the returned fast sequence.
+
+*/
+PyObject*
+fast_items( PyObject* arg, std::vector<PyObject*>& out )
+{
+	PyObject* items = PySequence_Fast( arg, "expected a sequence" );
+	if( !items )
+		return 0;
+	Py_ssize_t size = PySequence_Fast_GET_SIZE( items );
+	PyObject** objects = PySequence_Fast_ITEMS( items );
+	out.assign( objects, objects + size );
+	return items;
+}
+
+
+PyObject*
+add_constraints( PyObject* mod, PyObject* args )
+{
+	PyObject* solver;
+	PyObject* arg;
+	if( !PyArg_ParseTuple( args, "OO", &solver, &arg ) )
+		return 0;
+	std::vector<PyObject*> constraints;
+	PyObject* items = fast_items( arg, constraints );
+	if( !items )
+		return 0;
+	int result = api->Solver_AddConstraints( solver, constraints.data(), constraints.size() );
+	Py_DECREF( items );
+	if( result < 0 )
+		return 0;
+	Py_RETURN_NONE;
+}
+
+
+PyObject*
+remove_constraints( PyObject* mod, PyObject* args )
+{
+	PyObject* solver;
+	PyObject* arg;
+	if( !PyArg_ParseTuple( args, "OO", &solver, &arg ) )
+		return 0;
+	std::vector<PyObject*> constraints;
+	PyObject* items = fast_items( arg, constraints );
+	if( !items )
+		return 0;
+	int result = api->Solver_RemoveConstraints( solver, constraints.data(), constraints.size() );
+	Py_DECREF( items );
+	if( result < 0 )
+		return 0;
+	Py_RETURN_NONE;
+}
+
+
+PyObject*
+suggest_values( PyObject* mod, PyObject* args )
+{
+	PyObject* solver;
+	PyObject* arg;
+	double value;
+	if( !PyArg_ParseTuple( args, "OOd", &solver, &arg, &value ) )
+		return 0;
+	std::vector<PyObject*> variables;
+	PyObject* items = fast_items( arg, variables );
+	if( !items )
+		return 0;
+	std::vector<double> values( variables.size(), value );
+	int result = api->Solver_SuggestValues(
+		solver, variables.data(), values.data(), variables.size() );
+	if( result == 0 )
+		result = api->Solver_UpdateVariables( solver );
+	Py_DECREF( items );
+	if( result < 0 )
+		return 0;
+	Py_RETURN_NONE;
+}
+
+
+/* Release the GIL while the kiwi solver pivots.
+
+*/
+class GilRelease : public kiwi::PivotLock
+{
+
+public:
+
+	void unlock() override
+	{
+		m_state = PyEval_SaveThread();
+	}
+
+	void lock() override
+	{
+		PyEval_RestoreThread( m_state );
+	}
+
+private:
+
+	PyThreadState* m_state = 0;
+};
+
+
+/* Suggest a value to the kiwi solver directly, without the GIL while it pivots.
+
+*/
+PyObject*
+suggest_directly( PyObject* mod, PyObject* args )
+{
+	PyObject* solver;
+	PyObject* pyvar;
+	double value;
+	if( !PyArg_ParseTuple( args, "OOd", &solver, &pyvar, &value ) )
+		return 0;
+	kiwi::Variable* variable = api->Variable_AsVariable( pyvar );
+	if( !variable )
+		return 0;
+	kiwi::Solver* ksolver = api->Solver_Acquire( solver );
+	if( !ksolver )
+		return 0;
+	bool known = ksolver->hasEditVariable( *variable );
+	if( known )
+	{
+		GilRelease release;
+		ksolver->setPivotLock( &release );
+		ksolver->suggestValue( *variable, value );
+		ksolver->updateVariables();
+		ksolver->setPivotLock( 0 );
+	}
+	api->Solver_Release( solver );
+	if( !known )
+	{
+		PyErr_SetString( PyExc_ValueError, "not an edit variable" );
+		return 0;
+	}
+	return PyFloat_FromDouble( variable->value() );
+}
+
+
+PyObject*
+constraint_strength( PyObject* mod, PyObject* arg )
+{
+	kiwi::Constraint* constraint = api->Constraint_AsConstraint( arg );
+	if( !constraint )
+		return 0;
+	return PyFloat_FromDouble( constraint->strength() );
+}
+
+
+PyMethodDef methods[] = {
+	{ "add_constraints", add_constraints, METH_VARARGS, 0 },
+	{ "remove_constraints", remove_constraints, METH_VARARGS, 0 },
+	{ "suggest_values", suggest_values, METH_VARARGS, 0 },
+	{ "suggest_directly", suggest_directly, METH_VARARGS, 0 },
+	{ "constraint_strength", constraint_strength, METH_O, 0 },
+	{ 0 } // sentinel
+};
+
+
+PyModuleDef moduledef = {
+	PyModuleDef_HEAD_INIT,
+	"capi_consumer",
+	"Test extension of the kiwisolver C API",
+	-1,
+	methods,
+};
+
+}  // namespace
+
+
+PyMODINIT_FUNC PyInit_capi_consumer( void )
+{
+	api = KiwiSolver_ImportCAPI();
+	if( !api )
+		return 0;
+	PyObject* mod = PyModule_Create( &moduledef );
+#ifdef Py_GIL_DISABLED
+	if( mod )
+		PyUnstable_Module_SetGIL( mod, Py_MOD_GIL_NOT_USED );
+#endif
+	return mod;
+}
@@ -0,0 +1,36 @@
+# --------------------------------------------------------------------------------------
+# Copyright (c) 2013-2026, Nucleic Development Team.
+#
+# Distributed under the terms of the Modified BSD License.
+#
+# The full license is in the file LICENSE, distributed with this software.
+# --------------------------------------------------------------------------------------
+import asyncio
+
+import pytest
+
+from kiwisolver import UnknownEditVariable, Variable
+from kiwisolver.aio import AsyncSolver
+
+
+def test_async_solver() -> None:
+    """Test awaiting the solver operations."""
+
+    async def layout() -> float:
+        s = AsyncSolver()
+        x = Variable("x")
+        y = Variable("y")
+        c = y == 2 * x
+        await s.addConstraint(c)
+        await s.addEditVariable(x, "strong")
+        await s.suggestValue(x, 3)
+        await s.updateVariables()
+        value = y.value()
+        with pytest.raises(UnknownEditVariable):
+            await s.suggestValue(y, 1)
+        await s.removeEditVariable(x)
+        await s.removeConstraint(c)
+        assert not s.solver.hasConstraint(c)
+        return value
+
+    assert asyncio.run(layout()) == 6
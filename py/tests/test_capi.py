@@ -0,0 +1,133 @@
+# --------------------------------------------------------------------------------------
+# Copyright (c) 2026, Nucleic Development Team.
+#
+# Distributed under the terms of the Modified BSD License.
+#
+# The full license is in the file LICENSE, distributed with this software.
+# --------------------------------------------------------------------------------------
+import functools
+import importlib.util
+import os
+import sys
+import sysconfig
+import tempfile
+
+import pytest
+
+import kiwisolver
+from kiwisolver import (
+    DuplicateConstraint,
+    Solver,
+    UnknownConstraint,
+    UnknownEditVariable,
+    Variable,
+    strength,
+)
+
+ROOT = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+SOURCE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "capi", "capi_consumer.cpp")
+
+
+@functools.lru_cache(maxsize=None)
+def build_consumer():
+    """Build and import the test extension of the C API."""
+    if sys.implementation.name != "cpython":
+        pytest.skip("the C API is only tested on CPython")
+    include_dirs = [kiwisolver.get_include()]
+    # The kiwi headers are only shipped by the built package, so fall back on
+    # those of the source tree when testing in place.
+    if not os.path.isfile(os.path.join(include_dirs[0], "kiwi", "kiwi.h")):
+        if not os.path.isfile(os.path.join(ROOT, "kiwi", "kiwi.h")):
+            pytest.skip("the kiwi headers are not available")
+        include_dirs.append(ROOT)
+    try:
+        from setuptools import Distribution, Extension
+        from setuptools.command.build_ext import build_ext
+    except ImportError:
+        pytest.skip("setuptools is not available")
+
+    ext = Extension(
+        "capi_consumer",
+        [SOURCE],
+        include_dirs=include_dirs,
+        define_macros=(
+            [("KIWI_ATOMIC_REFCOUNT", None)]
+            if sysconfig.get_config_var("Py_GIL_DISABLED")
+            else []
+        ),
+        language="c++",
+    )
+    build_dir = tempfile.mkdtemp()
+    cmd = build_ext(Distribution({"ext_modules": [ext]}))
+    cmd.build_lib = build_dir
+    cmd.build_temp = build_dir
+    cmd.ensure_finalized()
+    try:
+        cmd.run()
+    except Exception as e:
+        pytest.skip(f"the test extension could not be built: {e}")
+    spec = importlib.util.spec_from_file_location(
+        "capi_consumer", cmd.get_ext_fullpath("capi_consumer")
+    )
+    mod = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(mod)
+    return mod
+
+
+def test_capi_capsule() -> None:
+    """Test that the C API table is exported."""
+    assert type(kiwisolver._cext._C_API).__name__ == "PyCapsule"
+    assert os.path.isfile(os.path.join(kiwisolver.get_include(), "kiwisolver", "capi.h"))
+
+
+def test_capi_constraints() -> None:
+    """Test adding and removing constraints through the C API."""
+    capi = build_consumer()
+    v1 = Variable("foo")
+    v2 = Variable("bar")
+    s = Solver()
+    cns = [v1 + v2 == 10, (v1 == 4) | "strong", v2 >= 0]
+    capi.add_constraints(s, cns)
+    assert all(s.hasConstraint(c) for c in cns)
+    s.updateVariables()
+    assert v1.value() == pytest.approx(4) and v2.value() == pytest.approx(6)
+    assert capi.constraint_strength(cns[1]) == strength.strong
+
+    with pytest.raises(DuplicateConstraint) as excinfo:
+        capi.add_constraints(s, [v1 >= -10, cns[2]])
+    assert excinfo.value.constraint is cns[2]
+    capi.remove_constraints(s, cns[:2])
+    assert not s.hasConstraint(cns[0]) and s.hasConstraint(cns[2])
+    with pytest.raises(UnknownConstraint):
+        capi.remove_constraints(s, cns[:1])
+    with pytest.raises(TypeError):
+        capi.add_constraints(s, [v1])
+    with pytest.raises(TypeError):
+        capi.add_constraints(v1, cns)
+
+
+def test_capi_edits() -> None:
+    """Test suggesting values through the C API, and on the kiwi solver."""
+    capi = build_consumer()
+    widths = [Variable(f"w{i}") for i in range(3)]
+    other = Variable("other")
+    s = Solver()
+    for w in widths:
+        s.addEditVariable(w, "strong")
+    capi.suggest_values(s, widths, 5)
+    assert [w.value() for w in widths] == [5, 5, 5]
+
+    with pytest.raises(UnknownEditVariable) as excinfo:
+        capi.suggest_values(s, [widths[0], other], 1)
+    assert excinfo.value.edit_variable is other
+    with pytest.raises(TypeError):
+        capi.suggest_values(s, [1], 1)
+
+    assert capi.suggest_directly(s, widths[1], 12) == 12
+    assert widths[1].value() == 12
+    with pytest.raises(ValueError):
+        capi.suggest_directly(s, other, 1)
+    # The lock was released, so the solver can still be used from Python.
+    s.suggestValue(widths[1], 3)
+    s.updateVariables()
+    assert widths[1].value() == 3
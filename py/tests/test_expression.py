@@ -9,6 +9,7 @@ import gc
 import math
 import operator
 import sys
+import weakref
 from typing import Tuple
 
 import pytest
@@ -48,6 +49,62 @@ def test_expression_creation() -> None:
     gc.collect()
 
 
+def test_expression_terms_storage() -> None:
+    """Test the terms tuple made on access, and cycles through the variables."""
+    v = Variable("foo")
+    v2 = Variable("bar")
+    e = 2 * v + v2 + v + 1
+    t = e.terms()
+    assert t is e.terms()
+    assert [(x.variable(), x.coefficient()) for x in t] == [(v, 2), (v2, 1), (v, 1)]
+    assert (e * 1).terms() is not t
+    assert Expression(()).terms() == ()
+
+    class SubExpression(Expression):
+        pass
+
+    s = SubExpression(t, 3)
+    s.attr = 1
+    assert str(s) == "2 * foo + 1 * bar + 1 * foo + 3"
+
+    class Context:
+        pass
+
+    ctx = Context()
+    ctx.expr = v + 1
+    v.setContext(ctx)
+    ref = weakref.ref(ctx)
+    del v, ctx, e, t, s
+    gc.collect()
+    assert ref() is None
+
+
+def test_expression_subclass() -> None:
+    """Test subclasses of Expression, and weak references to expressions."""
+    v = Variable("foo")
+    terms = (Term(v, 2), Term(v, 3))
+
+    class SubExpression(Expression):
+        pass
+
+    s = SubExpression(terms, 1)
+    assert type(s) is SubExpression
+    assert s.terms() is terms
+    assert s.constant() == 1
+    assert str(s) == "2 * foo + 3 * foo + 1"
+    assert isinstance(s + 1, Expression)
+
+    e = Expression(terms)
+    assert e.terms() is terms
+    # Expressions made by the operators hold new Term objects.
+    assert (e + 1).terms()[0] is not terms[0]
+
+    refs = [weakref.ref(s), weakref.ref(e)]
+    del s, e
+    gc.collect()
+    assert [ref() for ref in refs] == [None, None]
+
+
 @pytest.fixture()
 def expressions():
     """Build expressions, terms and variables to test operations."""
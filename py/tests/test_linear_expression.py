@@ -0,0 +1,129 @@
+# --------------------------------------------------------------------------------------
+# Copyright (c) 2026, Nucleic Development Team.
+#
+# Distributed under the terms of the Modified BSD License.
+#
+# The full license is in the file LICENSE, distributed with this software.
+# --------------------------------------------------------------------------------------
+import gc
+import operator
+
+import pytest
+
+from kiwisolver import (
+    Constraint,
+    Expression,
+    LinearExpression,
+    Solver,
+    Term,
+    Variable,
+    strength,
+)
+
+
+def coefficients(e: Expression) -> dict:
+    return {t.variable().name(): t.coefficient() for t in e.terms()}
+
+
+def test_linear_expression_building() -> None:
+    """Test accumulating terms in place."""
+    v = Variable("foo")
+    v2 = Variable("bar")
+    v3 = Variable("aux")
+
+    le = LinearExpression()
+    assert isinstance(le.expression(), Expression)
+    assert le.expression().terms() == () and le.expression().constant() == 0
+    assert LinearExpression(5).expression().constant() == 5
+
+    le.addTerm(v)
+    le.addTerm(v2, 2)
+    le.addTerms([v, v3], [3, 4.5])
+    le.addTerms((v2,))
+    e = le.expression()
+    assert coefficients(e) == {"foo": 4, "bar": 3, "aux": 4.5}
+    assert str(le) == str(e)
+
+    ref = le
+    le += Term(v, 2)
+    le += 2 * v + v3 + 1
+    le -= v2
+    le += 10
+    le -= 0.5
+    le += le
+    assert le is ref
+    e = le.expression()
+    assert coefficients(e) == {"foo": 16, "bar": 4, "aux": 11}
+    assert e.constant() == 21
+
+    with pytest.raises(TypeError):
+        le.addTerm(1)  # type: ignore
+    with pytest.raises(TypeError):
+        le.addTerms([v, 1])  # type: ignore
+    with pytest.raises(ValueError):
+        le.addTerms([v, v2], [1])
+    with pytest.raises(TypeError):
+        le += "a"  # type: ignore
+    assert coefficients(le.expression()) == {"foo": 16, "bar": 4, "aux": 11}
+
+    # ensure we test garbage collection.
+    del le, ref
+    gc.collect()
+
+
+def test_linear_expression_operators() -> None:
+    """Test the binary operators, which return new expressions."""
+    v = Variable("foo")
+    v2 = Variable("bar")
+    le = LinearExpression()
+    le += v
+
+    for e in (le + v2, v2 + le, le - v2, 5 - le, le + le):
+        assert isinstance(e, LinearExpression) and e is not le
+    assert coefficients((le - v2).expression()) == {"foo": 1, "bar": -1}
+    assert coefficients((v2 - le).expression()) == {"foo": -1, "bar": 1}
+    assert (5 - le).expression().constant() == 5
+    assert coefficients(le.expression()) == {"foo": 1}
+
+
+@pytest.mark.parametrize(
+    "op, symbol", [(operator.le, "<="), (operator.eq, "=="), (operator.ge, ">=")]
+)
+def test_linear_expression_rich_compare_operations(op, symbol) -> None:
+    """Test making constraints from a linear expression."""
+    v = Variable("foo")
+    v2 = Variable("bar")
+    le = LinearExpression()
+    le.addTerms([v, v2, v], [1, 2, 3])
+    other = LinearExpression(2)
+
+    for c in (op(le, 10), op(le, v2), op(le, Term(v2)), op(le, v2 + 1), op(le, other)):
+        assert isinstance(c, Constraint)
+        assert c.op() == symbol and c.strength() == strength.required
+    c = op(le, v2 + 1)
+    assert coefficients(c.expression()) == {"foo": 4, "bar": 1}
+    assert c.expression().constant() == -1
+
+    # The reflected comparison keeps the linear expression on the left.
+    c = op(10, le)
+    assert coefficients(c.expression()) == {"foo": 4, "bar": 2}
+    reflected = {"<=": ">=", "==": "==", ">=": "<="}[symbol]
+    assert c.op() == reflected
+
+    with pytest.raises(TypeError):
+        le < 1  # type: ignore
+
+
+def test_linear_expression_solving() -> None:
+    """Test a sum built in place in a solver."""
+    widths = [Variable(f"w{i}") for i in range(100)]
+    total = LinearExpression()
+    total.addTerms(widths)
+    s = Solver()
+    s.addConstraint(total == 1000)
+    for w in widths:
+        s.addConstraint(w >= 5)
+        s.addConstraint((w == 10) | "weak")
+    s.updateVariables()
+    assert sum(w.value() for w in widths) == pytest.approx(1000)
+    assert total.value() == pytest.approx(1000)
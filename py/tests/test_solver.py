@@ -5,6 +5,9 @@
 #
 # The full license is in the file LICENSE, distributed with this software.
 # --------------------------------------------------------------------------------------
+import threading
+from array import array
+
 import pytest
 
 from kiwisolver import (
@@ -16,6 +19,7 @@ from kiwisolver import (
     UnknownEditVariable,
     UnsatisfiableConstraint,
     Variable,
+    strength,
 )
 
 
@@ -42,6 +46,14 @@ def test_managing_edit_variable() -> None:
         s.removeEditVariable(object())  # type: ignore
     with pytest.raises(TypeError):
         s.suggestValue(object(), 10)  # type: ignore
+    with pytest.raises(TypeError, match=r"takes 2 arguments \(1 given\)"):
+        s.suggestValue(v1)  # type: ignore
+    with pytest.raises(TypeError):
+        s.addEditVariable(v1, "weak", 1)  # type: ignore
+    with pytest.raises(TypeError):
+        s.suggestValue(v1, value=10)  # type: ignore
+    with pytest.raises(TypeError, match="at most 2"):
+        s.values([v1], None, None)  # type: ignore
 
     assert not s.hasEditVariable(v1)
     s.addEditVariable(v1, "weak")
@@ -293,3 +305,198 @@ def test_constraint_violated():
     assert v.value() >= 10
     assert c1.violated() is False
     assert c2.violated() is True
+
+
+def test_releasing_the_gil() -> None:
+    """Test solvers used from several threads without the GIL."""
+    s = Solver()
+    with pytest.raises(TypeError):
+        s.setGilThreshold(1.0)  # type: ignore
+    with pytest.raises(ValueError):
+        s.setGilThreshold(-1)
+
+    def layout(width: int, results: list) -> None:
+        solver = Solver()
+        # Release the GIL for every operation.
+        solver.setGilThreshold(1)
+        w = Variable("w")
+        xs = [Variable() for _ in range(20)]
+        solver.addEditVariable(w, "strong")
+        solver.addConstraint(xs[0] == 0)
+        for a, b in zip(xs, xs[1:]):
+            solver.addConstraint(b >= a + 1)
+            solver.addConstraint((b == a + 10) | "weak")
+        with pytest.raises(DuplicateEditVariable):
+            solver.addEditVariable(w, "strong")
+        solver.addConstraint(xs[-1] <= w)
+        solver.suggestValue(w, width)
+        solver.updateVariables()
+        results.append(xs[-1].value())
+
+    results: list = []
+    threads = [
+        threading.Thread(target=layout, args=(100 + i, results)) for i in range(4)
+    ]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    assert sorted(results) == [100, 101, 102, 103]
+
+
+def test_bulk_methods() -> None:
+    """Test adding and removing constraints and edits in bulk."""
+    s = Solver()
+    total = Variable("total")
+    offset = Variable("offset")
+    lefts = [Variable(f"left{i}") for i in range(10)]
+    widths = [Variable(f"width{i}") for i in range(10)]
+    constraints = [lefts[0] == offset, lefts[-1] + widths[-1] <= total]
+    for i in range(10):
+        constraints.append(widths[i] >= 10)
+        constraints.append((widths[i] == 50) | "weak")
+        if i > 0:
+            constraints.append(lefts[i] >= lefts[i - 1] + widths[i - 1] + 5)
+
+    s.addEditVariables([(total, "strong"), (offset, "strong")])
+    s.addConstraints(constraints)
+    s.suggestValues([(total, 300), (offset, 20.0)])
+    s.updateVariables()
+    assert lefts[0].value() == 20
+    assert lefts[-1].value() + widths[-1].value() <= 300
+    assert all(s.hasConstraint(c) for c in constraints)
+
+    extra = lefts[0] >= 0
+    impossible = lefts[1] <= -100
+    with pytest.raises(DuplicateConstraint) as e:
+        s.addConstraints([extra, constraints[3]])
+    assert e.value.constraint is constraints[3]
+    with pytest.raises(UnsatisfiableConstraint) as e:
+        s.addConstraints((extra, impossible))
+    assert e.value.constraint is impossible
+    assert not s.hasConstraint(extra)
+    with pytest.raises(TypeError):
+        s.addConstraints([extra, 1])  # type: ignore
+    with pytest.raises(TypeError):
+        s.addConstraints(1)  # type: ignore
+
+    with pytest.raises(UnknownConstraint) as e:
+        s.removeConstraints([constraints[0], extra])
+    assert e.value.constraint is extra
+    assert s.hasConstraint(constraints[0])
+
+    with pytest.raises(DuplicateEditVariable) as e:
+        s.addEditVariables([(widths[0], "weak"), (total, "weak")])
+    assert e.value.edit_variable is total
+    assert not s.hasEditVariable(widths[0])
+    with pytest.raises(BadRequiredStrength):
+        s.addEditVariables([[widths[0], "required"]])
+    with pytest.raises(TypeError):
+        s.addEditVariables([(widths[0],)])  # type: ignore
+
+    with pytest.raises(UnknownEditVariable) as e:
+        s.suggestValues([(total, 100), (widths[0], 1)])
+    assert e.value.edit_variable is widths[0]
+    with pytest.raises(TypeError):
+        s.suggestValues([(total, "100")])  # type: ignore
+
+    s.removeConstraints(constraints)
+    assert not any(s.hasConstraint(c) for c in constraints)
+
+
+def test_reading_values() -> None:
+    """Test reading the values of many variables at once."""
+    s = Solver()
+    xs = [Variable(f"x{i}") for i in range(5)]
+    s.addEditVariable(xs[0], "strong")
+    for a, b in zip(xs, xs[1:]):
+        s.addConstraint(b == a + 1)
+    s.suggestValue(xs[0], 10)
+    s.updateVariables()
+
+    assert s.values(xs) == [10, 11, 12, 13, 14]
+    assert s.values(()) == []
+    out = array("d", bytes(8 * len(xs)))
+    assert s.values(xs, out) is out
+    assert list(out) == [10, 11, 12, 13, 14]
+    view = memoryview(out)
+    s.values(xs[::-1], view)
+    assert list(out) == [14, 13, 12, 11, 10]
+
+    with pytest.raises(TypeError):
+        s.values([xs[0], 1])  # type: ignore
+    with pytest.raises(ValueError):
+        s.values(xs, array("d", [0.0]))
+    with pytest.raises(ValueError):
+        s.values(xs, array("f", bytes(4 * len(xs))))
+    with pytest.raises(BufferError):
+        s.values(xs, bytes(8 * len(xs)))
+
+
+def test_adding_linear_constraints() -> None:
+    """Test creating constraints from the rows of a sparse matrix."""
+    s = Solver()
+    xs = [Variable(f"x{i}") for i in range(3)]
+    # x0 == 1, x1 - x0 >= 2 (weak), x2 - x1 >= 3 with x1 repeated, x2 <= 10
+    indptr = array("i", [0, 1, 3, 6, 7])
+    indices = array("q", [0, 1, 0, 2, 1, 1, 2])
+    data = array("d", [1, 1, -1, 1, -0.5, -0.5, 1])
+    rhs = array("f", [1, 2, 3, 10])
+    cns = s.addLinearConstraints(
+        xs, indptr, indices, data, rhs, ["==", ">=", ">=", "<="], [1e9, "weak", 1e9, 1e9]
+    )
+    assert len(cns) == 4
+    assert all(s.hasConstraint(c) for c in cns)
+    assert cns[1].strength() == strength.weak
+    assert cns[2].op() == ">="
+    assert sorted(t.coefficient() for t in cns[2].expression().terms()) == [-1, 1]
+    assert cns[2].expression().constant() == -3
+    s.updateVariables()
+    assert xs[0].value() == 1
+    assert xs[2].value() - xs[1].value() >= 3
+
+    # One op and strength for all rows, and memoryviews of other formats.
+    ys = [Variable(f"y{i}") for i in range(2)]
+    cns = s.addLinearConstraints(
+        ys,
+        memoryview(array("b", [0, 1, 2])),
+        array("H", [0, 1]),
+        array("d", [1, 1]),
+        array("d", [5, 6]),
+        "==",
+    )
+    s.updateVariables()
+    assert [y.value() for y in ys] == [5, 6]
+    assert cns[0].strength() == strength.required
+
+    with pytest.raises(UnsatisfiableConstraint) as e:
+        s.addLinearConstraints(
+            ys, array("i", [0, 1, 2]), array("i", [0, 0]), array("d", [1, 1]),
+            array("d", [0, 5]), "=="
+        )
+    assert e.value.constraint.expression().constant() == 0
+    with pytest.raises(TypeError):
+        s.addLinearConstraints(
+            ys, array("d", [0, 1]), array("i", [0]), array("d", [1]),
+            array("d", [0]), "=="
+        )
+    with pytest.raises(ValueError):
+        s.addLinearConstraints(
+            ys, array("i", [0, 1]), array("i", [0]), array("d", [1]),
+            array("d", [0, 1]), "=="
+        )
+    with pytest.raises(ValueError):
+        s.addLinearConstraints(
+            ys, array("i", [0, 2]), array("i", [0]), array("d", [1]),
+            array("d", [0]), "=="
+        )
+    with pytest.raises(IndexError):
+        s.addLinearConstraints(
+            ys, array("i", [0, 1]), array("i", [2]), array("d", [1]),
+            array("d", [0]), "=="
+        )
+    with pytest.raises(ValueError):
+        s.addLinearConstraints(
+            ys, array("i", [0, 1]), array("i", [0]), array("d", [1]),
+            array("d", [0]), ["==", "<="]
+        )
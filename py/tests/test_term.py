@@ -36,6 +36,20 @@ def test_term_creation() -> None:
     del t
     gc.collect()
 
+    # Terms reuse the memory of freed terms, subclasses do not.
+    class SubTerm(Term):
+        pass
+
+    terms = [Term(v, i) for i in range(1000)]
+    del terms
+    st = SubTerm(v)
+    assert type(st) is SubTerm and st.coefficient() == 1
+    t = Term(Variable("bar"))
+    assert t.variable().name() == "bar" and t.coefficient() == 1
+    assert gc.is_tracked(t)
+    del st
+    gc.collect()
+
 
 @pytest.fixture()
 def terms():
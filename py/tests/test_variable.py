@@ -5,9 +5,11 @@
 #
 # The full license is in the file LICENSE, distributed with this software.
 # --------------------------------------------------------------------------------------
+import gc
 import math
 import operator
 import sys
+import weakref
 
 import pytest
 
@@ -41,6 +43,67 @@ def test_variable_methods() -> None:
         Variable(1)  # type: ignore
 
 
+def test_variable_creation_arguments() -> None:
+    """Test the positional and keyword arguments of the constructor."""
+    ctx = object()
+    for v in (
+        Variable("foo", ctx),
+        Variable(name="foo", context=ctx),
+        Variable("foo", context=ctx),
+    ):
+        assert v.name() == "foo" and v.context() is ctx
+    assert Variable(context=ctx).name() == ""
+
+    with pytest.raises(TypeError):
+        Variable("foo", ctx, 1)  # type: ignore
+    with pytest.raises(TypeError):
+        Variable("foo", name="bar")  # type: ignore
+    with pytest.raises(TypeError):
+        Variable(other=1)  # type: ignore
+
+    class NamedVariable(Variable):
+        def __init__(self, name, context=None):
+            self.initialized = True
+
+    v = NamedVariable("foo")
+    assert v.name() == "foo" and v.initialized
+
+
+@pytest.mark.skipif("PyPy" in sys.version, reason="PyPy has no GC tracking")
+def test_variable_gc_tracking() -> None:
+    """Test that only variables with a context are tracked by the collector."""
+    assert not gc.is_tracked(Variable("foo"))
+    assert gc.is_tracked(Variable("foo", object()))
+
+    class Context:
+        term: Term
+
+    # A cycle through the context is still collected.
+    v = Variable("foo")
+    ctx = Context()
+    v.setContext(ctx)
+    assert gc.is_tracked(v)
+    ctx.term = Term(v)
+    ref = weakref.ref(ctx)
+    del v, ctx
+    gc.collect()
+    assert ref() is None
+
+    # Instances of subclasses can be in cycles through their dict.
+    class SubVariable(Variable):
+        pass
+
+    assert gc.is_tracked(SubVariable("foo"))
+    for make_cycle in (lambda v: v, lambda v: v + 1):
+        v = SubVariable("foo")
+        v.attr = make_cycle(v)
+        v.marker = marker = Context()
+        ref = weakref.ref(marker)
+        del v, marker
+        gc.collect()
+        assert ref() is None
+
+
 def test_variable_neg() -> None:
     """Test neg on a variable."""
     v = Variable("foo")
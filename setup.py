@@ -6,7 +6,12 @@
 # The full license is in the file LICENSE, distributed with this software.
 # --------------------------------------------------------------------------------------
 
+import glob
+import os
+import sysconfig
+
 from setuptools import Extension, setup
+from setuptools.command.build_py import build_py
 
 try:
     from cppy import CppyBuildExt
@@ -19,25 +24,45 @@ except ImportError as e:
 # Before releasing the version needs to be updated in kiwi/version.h, if the changes
 # are not limited to the solver.
 
+# Free-threaded builds share kiwi objects across threads running at once, which
+# requires atomic reference counts. GIL builds keep the cheaper plain ones.
+define_macros = []
+if sysconfig.get_config_var("Py_GIL_DISABLED"):
+    define_macros.append(("KIWI_ATOMIC_REFCOUNT", None))
+
 ext_modules = [
     Extension(
         "kiwisolver._cext",
         [
             "py/src/kiwisolver.cpp",
+            "py/src/capi.cpp",
             "py/src/constraint.cpp",
             "py/src/expression.cpp",
+            "py/src/linearexpression.cpp",
             "py/src/solver.cpp",
             "py/src/strength.cpp",
             "py/src/term.cpp",
             "py/src/variable.cpp",
         ],
-        include_dirs=["."],
+        include_dirs=[".", "py/kiwisolver/include"],
+        define_macros=define_macros,
         language="c++",
     ),
 ]
 
 
+class BuildPy(build_py):
+    """Ship the kiwi headers next to the header of the C API."""
+
+    def run(self):
+        super().run()
+        target = os.path.join(self.build_lib, "kiwisolver", "include", "kiwi")
+        self.mkpath(target)
+        for header in sorted(glob.glob(os.path.join("kiwi", "*.h"))):
+            self.copy_file(header, target)
+
+
 setup(
     ext_modules=ext_modules,
-    cmdclass={"build_ext": CppyBuildExt},
+    cmdclass={"build_ext": CppyBuildExt, "build_py": BuildPy},
 )
@@ -0,0 +1,157 @@
+/*-----------------------------------------------------------------------------
+| Copyright (c) 2013-2026, Nucleic Development Team.
+|
+| Distributed under the terms of the Modified BSD License.
+|
+| The full license is in the file LICENSE, distributed with this software.
+|----------------------------------------------------------------------------*/
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <kiwi/kiwi.h>
+
+using namespace kiwi;
+
+// Test that the last posted value of each edit variable is solved
+TEST(AsyncSolverTest, PostAndWait) {
+    Solver s;
+    Variable x("x");
+    Variable y("y");
+    s.addConstraint(y == 2 * x);
+    s.addEditVariable(x, strength::strong);
+
+    AsyncSolver async(s, {x});
+    async.post(x, 1.0);
+    async.post(x, 2.0);
+    AsyncSolver::Generation generation = async.post(std::size_t(0), 3.0);
+    EXPECT_EQ(generation, 3u);
+    async.solved(generation).get();
+    EXPECT_GE(async.solvedGeneration(), generation);
+    EXPECT_DOUBLE_EQ(x.value(), 3.0);
+    EXPECT_DOUBLE_EQ(y.value(), 6.0);
+
+    EXPECT_THROW(async.post(y, 1.0), UnknownEditVariable);
+}
+
+// Test coalescing of the posts from concurrent producers
+TEST(AsyncSolverTest, ConcurrentProducers) {
+    Solver s;
+    Variable x("x");
+    Variable y("y");
+    Variable sum("sum");
+    s.addConstraint(sum == x + y);
+    s.addEditVariable(x, strength::strong);
+    s.addEditVariable(y, strength::strong);
+
+    AsyncSolver async(s, {x, y});
+    std::atomic<int> solves(0);
+    async.setCallback([&](AsyncSolver::Generation) { ++solves; });
+
+    const int posts = 2000;
+    std::vector<std::thread> producers;
+    for (std::size_t slot = 0; slot < 2; ++slot) {
+        producers.emplace_back([&async, slot] {
+            for (int i = 1; i <= posts; ++i)
+                async.post(slot, double(i));
+        });
+    }
+    for (auto &producer : producers)
+        producer.join();
+
+    async.solved(2 * posts).get();
+    EXPECT_DOUBLE_EQ(x.value(), posts);
+    EXPECT_DOUBLE_EQ(y.value(), posts);
+    EXPECT_DOUBLE_EQ(sum.value(), 2 * posts);
+    EXPECT_LE(solves.load(), 2 * posts);
+}
+
+// Test changing the constraints while the solver thread runs
+TEST(AsyncSolverTest, WithSolver) {
+    Solver s;
+    Variable x("x");
+    Variable y("y");
+    s.addEditVariable(x, strength::strong);
+
+    AsyncSolver async(s, {x});
+    Constraint c(y == x + 1);
+    async.withSolver([&](Solver &solver) { solver.addConstraint(c); });
+    async.solved(async.post(x, 4.0)).get();
+    EXPECT_DOUBLE_EQ(y.value(), 5.0);
+
+    bool has = async.withSolver([&](Solver &solver) { return solver.hasConstraint(c); });
+    EXPECT_TRUE(has);
+}
+
+// Test that readers see the values of a single solve
+TEST(AsyncSolverTest, ValueSnapshot) {
+    Solver s;
+    Variable x("x");
+    Variable y("y");
+    Variable sum("sum");
+    s.addConstraint(sum == x + y);
+    s.addConstraint(y == 3 * x);
+    s.addEditVariable(x, strength::strong);
+
+    ValueSnapshot snapshot({x, y, sum});
+    EXPECT_EQ(snapshot.slot(sum), 2u);
+    EXPECT_EQ(snapshot.slot(Variable("z")), snapshot.size());
+    EXPECT_EQ(snapshot.version(), 0u);
+
+    AsyncSolver async(s, {x});
+    async.setCallback([&](AsyncSolver::Generation) { snapshot.publish(); });
+
+    std::atomic<bool> done(false);
+    std::atomic<int> torn(0);
+    std::thread reader([&] {
+        std::vector<double> values;
+        ValueSnapshot::Version last = 0;
+        while (!done.load()) {
+            ValueSnapshot::Version version = snapshot.read(values);
+            // A torn read mixes values which differ by whole units.
+            if (version < last || std::abs(values[1] - 3 * values[0]) > 1e-6 ||
+                std::abs(values[2] - values[0] - values[1]) > 1e-6)
+                ++torn;
+            last = version;
+        }
+    });
+
+    AsyncSolver::Generation generation = 0;
+    for (int i = 1; i <= 2000; ++i)
+        generation = async.post(x, double(i));
+    async.solved(generation).get();
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_GE(snapshot.version(), 1u);
+    EXPECT_DOUBLE_EQ(snapshot.value(0), 2000.0);
+    EXPECT_NEAR(snapshot.value(2), 8000.0, 1e-6);
+}
+
+#if defined(KIWI_ATOMIC_REFCOUNT)
+// Test building constraints on worker threads from shared variables
+TEST(AsyncSolverTest, AtomicRefcount) {
+    Variable x("x");
+    Variable y("y");
+    std::vector<std::vector<Constraint>> built(4);
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < built.size(); ++t) {
+        workers.emplace_back([&built, t, x, y] {
+            for (int i = 0; i < 1000; ++i)
+                built[t].push_back((x + i <= y + double(t)) | strength::weak);
+        });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    Solver s;
+    for (const auto &constraints : built)
+        for (const auto &constraint : constraints)
+            s.addConstraint(constraint);
+    s.updateVariables();
+    EXPECT_GE(y.value() - x.value(), 0.0);
+}
+#endif
@@ -219,3 +219,558 @@ TEST(SolverTest, ConstraintViolated) {
     EXPECT_FALSE(c1.violated());
     EXPECT_TRUE(c2.violated());
 }
+
+// Test that the parallel pivots give the same solution as the sequential ones
+TEST(SolverTest, ParallelPivots) {
+    const int count = 60;
+    std::vector<Variable> vars;
+    for (int i = 0; i < count; ++i)
+        vars.emplace_back("v" + std::to_string(i));
+
+    auto build = [&](Solver& s) {
+        s.addEditVariable(vars[0], strength::strong);
+        for (int i = 1; i < count; ++i)
+        {
+            s.addConstraint(vars[i] >= vars[i - 1] + 1);
+            s.addConstraint((vars[i] == vars[i - 1] + 5) | strength::weak);
+            s.addConstraint((vars[i] <= 3 * i) | strength::medium);
+        }
+    };
+
+    Solver sequential;
+    sequential.setParallelThreshold(0);
+    build(sequential);
+    std::vector<double> expected;
+    for (double value : {10.0, -20.0, 200.0}) {
+        sequential.suggestValue(vars[0], value);
+        sequential.updateVariables();
+        for (const auto& var : vars)
+            expected.push_back(var.value());
+    }
+
+    Solver parallel;
+    parallel.setParallelThreshold(1);
+    build(parallel);
+    std::size_t index = 0;
+    for (double value : {10.0, -20.0, 200.0}) {
+        parallel.suggestValue(vars[0], value);
+        parallel.updateVariables();
+        for (const auto& var : vars)
+            EXPECT_EQ(var.value(), expected[index++]);
+    }
+}
+
+// Test that the pivot lock is released during the pivots and held afterwards
+TEST(SolverTest, PivotLock) {
+    struct CountingLock : PivotLock {
+        void unlock() override { EXPECT_TRUE(held); held = false; ++unlocks; }
+        void lock() override { EXPECT_FALSE(held); held = true; }
+        bool held = true;
+        int unlocks = 0;
+    };
+
+    Variable x("x");
+    Variable y("y");
+    CountingLock lock;
+    Solver s;
+    s.setPivotLock(&lock);
+    s.addEditVariable(x, strength::strong);
+    s.addConstraint(y >= x + 10);
+    s.addConstraint((y == 0) | strength::weak);
+    s.suggestValue(x, 20);
+    s.updateVariables();
+    EXPECT_TRUE(lock.held);
+    EXPECT_GT(lock.unlocks, 0);
+    EXPECT_EQ(y.value(), 30);
+
+    int unlocks = lock.unlocks;
+    s.setPivotLock(nullptr);
+    s.suggestValue(x, 40);
+    EXPECT_EQ(lock.unlocks, unlocks);
+}
+
+// Test a chain layout in which every constraint introduces a new variable
+TEST(SolverTest, SolvingChainLayout) {
+    const int count = 50;
+    std::vector<Variable> top(count);
+    std::vector<Variable> height(count);
+    Variable bottom("bottom");
+    Solver s;
+
+    s.addConstraint(top[0] == 0);
+    for (int i = 0; i < count; ++i) {
+        s.addConstraint((height[i] == 20) | strength::weak);
+        s.addConstraint(height[i] >= 10);
+        if (i > 0)
+            s.addConstraint(top[i] == top[i - 1] + height[i - 1] + 5);
+    }
+    s.updateVariables();
+    for (int i = 0; i < count; ++i)
+        EXPECT_NEAR(top[i].value(), 25 * i, 1e-6);
+
+    // Closing the chain forces the solver back onto existing variables
+    s.addConstraint(bottom == top[count - 1] + height[count - 1]);
+    s.addConstraint(bottom <= 25 * count - 5 - 10 * count);
+    s.updateVariables();
+    EXPECT_NEAR(bottom.value(), 15 * count - 5, 1e-6);
+    for (int i = 0; i < count; ++i)
+        EXPECT_GE(height[i].value(), 10 - 1e-6);
+}
+
+// Test that the fill-in heuristic does not change the solution
+TEST(SolverTest, MinimizeFillIn) {
+    Variable xm("xm");
+    Variable xl("xl");
+    Variable xr("xr");
+    std::vector<double> results;
+
+    for (bool fill_in : {false, true}) {
+        Solver s;
+        s.setMinimizeFillIn(fill_in);
+        s.addEditVariable(xm, strength::strong);
+        s.addConstraint((xl == 0) | strength::weak);
+        s.addConstraint((xr == 0) | strength::weak);
+        s.addConstraint(2 * xm == xl + xr);
+        s.addConstraint(xl + 20 <= xr);
+        s.addConstraint(xl >= -10);
+        s.addConstraint(xr <= 100);
+        s.suggestValue(xm, 90);
+        s.updateVariables();
+        results.push_back(xl.value());
+        results.push_back(xr.value());
+
+        SolverStats stats = s.stats();
+        EXPECT_GT(stats.rows, 0u);
+        EXPECT_EQ(stats.rows, s.rowCount());
+        EXPECT_GE(stats.cells, stats.columns);
+        EXPECT_GT(stats.density(), 0.0);
+        EXPECT_LE(stats.density(), 1.0);
+    }
+    EXPECT_NEAR(results[0], 80, 1e-6);
+    EXPECT_NEAR(results[1], 100, 1e-6);
+    EXPECT_NEAR(results[2], results[0], 1e-6);
+    EXPECT_NEAR(results[3], results[1], 1e-6);
+}
+
+// Test that refactoring the tableau preserves the solution
+TEST(SolverTest, Refactor) {
+    Variable xm("xm");
+    Variable xl("xl");
+    Variable xr("xr");
+    Solver s;
+
+    s.addEditVariable(xm, strength::strong);
+    s.addEditVariable(xl, strength::weak);
+    s.addEditVariable(xr, strength::weak);
+    s.addConstraint(2 * xm == xl + xr);
+    s.addConstraint(xl + 20 <= xr);
+    s.addConstraint(xl >= -10);
+    s.addConstraint(xr <= 100);
+    s.suggestValue(xm, 40);
+    s.suggestValue(xr, 50);
+    s.suggestValue(xl, 30);
+
+    // Churn the tableau with constraints which are added and removed
+    for (int i = 0; i < 20; ++i) {
+        Constraint c = (xl >= 0.37 * xr - i) | strength::medium;
+        s.addConstraint(c);
+        s.suggestValue(xm, 60 + i);
+        s.removeConstraint(c);
+    }
+    s.suggestValue(xm, 90);
+    s.updateVariables();
+    double expected[] = {xm.value(), xl.value(), xr.value()};
+    std::size_t cells = s.stats().cells;
+
+    s.refactor();
+    s.updateVariables();
+    EXPECT_NEAR(xm.value(), expected[0], 1e-6);
+    EXPECT_NEAR(xl.value(), expected[1], 1e-6);
+    EXPECT_NEAR(xr.value(), expected[2], 1e-6);
+    EXPECT_LE(s.stats().cells, cells);
+
+    // The refactored tableau keeps working for edits and constraints
+    s.suggestValue(xm, 60);
+    s.addConstraint(xr <= 65);
+    s.updateVariables();
+    EXPECT_NEAR(xm.value(), 55, 1e-6);
+    EXPECT_NEAR(xl.value(), 45, 1e-6);
+    EXPECT_NEAR(xr.value(), 65, 1e-6);
+
+    // Automatic refactoring gives the same results as the default
+    Solver automatic;
+    automatic.setAutoRefactor(1);
+    automatic.addEditVariable(xm, strength::strong);
+    automatic.addConstraint(2 * xm == xl + xr);
+    automatic.addConstraint(xl + 20 <= xr);
+    automatic.addConstraint(xl >= -10);
+    automatic.addConstraint(xr <= 100);
+    automatic.suggestValue(xm, 90);
+    automatic.updateVariables();
+    EXPECT_NEAR(xl.value(), 80, 1e-6);
+    EXPECT_NEAR(xr.value(), 100, 1e-6);
+}
+
+// Test a suggestion which makes many rows infeasible at once
+TEST(SolverTest, DualOptimizeManyInfeasibleRows) {
+    const int count = 30;
+    std::vector<Variable> vars(count);
+    Solver s;
+
+    s.addEditVariable(vars[0], strength::strong);
+    for (int i = 1; i < count; ++i) {
+        s.addConstraint(vars[i] >= vars[i - 1] + 10);
+        s.addConstraint((vars[i] == 10 * i) | strength::weak);
+    }
+    for (double value : {100.0, -50.0, 250.0, 0.0}) {
+        s.suggestValue(vars[0], value);
+        s.updateVariables();
+        EXPECT_NEAR(vars[0].value(), value, 1e-6);
+        for (int i = 1; i < count; ++i)
+            EXPECT_NEAR(vars[i].value(), std::max(value, 0.0) + 10 * i, 1e-6);
+    }
+    EXPECT_GT(s.stats().dualPivots, 0u);
+}
+
+// Test adding required inequalities which are violated by the current solution
+TEST(SolverTest, AddingViolatedInequality) {
+    Variable x("x");
+    Variable y("y");
+    Solver s;
+
+    s.addConstraint(x >= 0);
+    s.addConstraint(y >= 0);
+    s.addConstraint(x + y <= 10);
+    s.addConstraint((x == 5) | strength::weak);
+    s.addConstraint((y == 5) | strength::weak);
+    s.updateVariables();
+    EXPECT_NEAR(x.value(), 5, 1e-6);
+    EXPECT_NEAR(y.value(), 5, 1e-6);
+
+    // The failed insertion leaves the solver as it was
+    Constraint unsatisfiable = x + y >= 20;
+    EXPECT_THROW(s.addConstraint(unsatisfiable), UnsatisfiableConstraint);
+    EXPECT_FALSE(s.hasConstraint(unsatisfiable));
+    s.updateVariables();
+    EXPECT_NEAR(x.value(), 5, 1e-6);
+    EXPECT_NEAR(y.value(), 5, 1e-6);
+
+    s.addConstraint(x >= 8);
+    s.updateVariables();
+    EXPECT_NEAR(x.value(), 8, 1e-6);
+    EXPECT_NEAR(y.value(), 2, 1e-6);
+    EXPECT_GT(s.stats().dualPivots, 0u);
+
+    s.addConstraint(y >= 1.5);
+    s.addConstraint(x <= 8.25);
+    s.updateVariables();
+    EXPECT_NEAR(x.value(), 8, 1e-6);
+    EXPECT_NEAR(y.value(), 2, 1e-6);
+    EXPECT_THROW(s.addConstraint(y >= 2.5), UnsatisfiableConstraint);
+}
+
+// Test suggestions which alternately keep and change the optimal basis
+TEST(SolverTest, SuggestValueWithinBasis) {
+    const int count = 10;
+    std::vector<Variable> vars(count);
+    Variable width("width");
+    auto build = [&](Solver& s) {
+        s.addEditVariable(vars[0], strength::strong);
+        s.addEditVariable(width, strength::strong);
+        for (int i = 1; i < count; ++i) {
+            s.addConstraint(vars[i] >= vars[i - 1] + 10);
+            s.addConstraint((vars[i] == vars[i - 1] + width) | strength::medium);
+            s.addConstraint(vars[i] <= 50 * i);
+        }
+    };
+
+    Solver s;
+    build(s);
+    double frames[][2] = {
+        {0, 20}, {1, 21}, {2, 21}, {2, 22}, {0, 60}, {-5, 5}, {-4, 6}, {3, 30}, {3, 31}
+    };
+    for (const auto& frame : frames) {
+        s.suggestValue(vars[0], frame[0]);
+        s.suggestValue(width, frame[1]);
+        s.updateVariables();
+        std::vector<double> values;
+        for (const auto& var : vars)
+            values.push_back(var.value());
+
+        Solver reference;
+        build(reference);
+        reference.suggestValue(vars[0], frame[0]);
+        reference.suggestValue(width, frame[1]);
+        reference.updateVariables();
+        for (int i = 0; i < count; ++i)
+            EXPECT_NEAR(values[i], vars[i].value(), 1e-6);
+    }
+}
+
+// Test that a sweep reproduces the solutions of the solver over a range
+TEST(SolverTest, Sweep) {
+    const int count = 8;
+    std::vector<Variable> left(count);
+    std::vector<Variable> width(count);
+    Variable total("total");
+    Solver s;
+
+    s.addEditVariable(total, strength::strong);
+    s.addConstraint(left[0] == 0);
+    for (int i = 0; i < count; ++i) {
+        s.addConstraint(width[i] >= 10 + 5 * i);
+        s.addConstraint((width[i] == 50) | strength::weak);
+        s.addConstraint((width[i] <= 20 + 10 * i) | strength::medium);
+        if (i > 0)
+            s.addConstraint(left[i] == left[i - 1] + width[i - 1] + 5);
+    }
+    s.addConstraint(left[count - 1] + width[count - 1] <= total);
+    s.suggestValue(total, 500);
+
+    SweepTable table = s.sweep(total, 0, 1200);
+    EXPECT_EQ(table.lower(), 0);
+    EXPECT_EQ(table.upper(), 1200);
+    EXPECT_GT(table.pieces(), 2u);
+
+    // The sweep leaves the suggested value unchanged
+    s.updateVariables();
+    EXPECT_NEAR(total.value(), 500, 1e-6);
+
+    std::vector<double> values;
+    for (double value = 0; value <= 1200; value += 37.5) {
+        s.suggestValue(total, value);
+        s.updateVariables();
+        table.evaluate(value, values);
+        for (std::size_t i = 0; i < values.size(); ++i)
+            EXPECT_NEAR(values[i], table.variables()[i].value(), 1e-6);
+    }
+    table.apply(1200);
+    EXPECT_NEAR(total.value(), 1200, 1e-6);
+
+    EXPECT_THROW(s.sweep(left[0], 0, 1), UnknownEditVariable);
+}
+
+// Test that a table without pieces can be evaluated and applied
+TEST(SolverTest, EmptySweepTable) {
+    SweepTable table;
+    EXPECT_EQ(table.pieces(), 0u);
+    EXPECT_EQ(table.value(0, 10), 0);
+    std::vector<double> values(3, 1.0);
+    table.evaluate(10, values);
+    EXPECT_TRUE(values.empty());
+    table.apply(10);
+
+    Variable v("v");
+    v.setValue(5);
+    SweepTable unfinished({v}, 0);
+    EXPECT_EQ(unfinished.pieces(), 0u);
+    EXPECT_EQ(unfinished.value(0, 10), 0);
+    unfinished.evaluate(10, values);
+    EXPECT_EQ(values, std::vector<double>(1, 0.0));
+    unfinished.apply(10);
+    EXPECT_EQ(v.value(), 5);
+}
+
+// Test that cached solutions match the solver when toggling between sizes
+TEST(SolverTest, SolutionCache) {
+    const int count = 6;
+    std::vector<Variable> left(count);
+    std::vector<Variable> width(count);
+    Variable total("total");
+    Variable height("height");
+    auto build = [&](Solver& s) {
+        s.addEditVariable(total, strength::strong);
+        s.addEditVariable(height, strength::strong);
+        s.addConstraint(left[0] == 0);
+        for (int i = 0; i < count; ++i) {
+            s.addConstraint(width[i] >= 10 + 5 * i);
+            s.addConstraint((width[i] == 50) | strength::weak);
+            s.addConstraint((width[i] <= height) | strength::medium);
+            if (i > 0)
+                s.addConstraint(left[i] == left[i - 1] + width[i - 1] + 5);
+        }
+        s.addConstraint(left[count - 1] + width[count - 1] <= total);
+    };
+    double sizes[][2] = {{400, 30}, {1200, 60}, {400, 30}, {800, 45}, {1200, 60}, {400.0000001, 30}};
+
+    for (bool reinstall : {false, true}) {
+        Solver reference;
+        build(reference);
+        std::vector<std::vector<double>> expected;
+        for (const auto& size : sizes) {
+            reference.suggestValue(total, size[0]);
+            reference.suggestValue(height, size[1]);
+            reference.updateVariables();
+            expected.emplace_back();
+            for (const auto& var : width)
+                expected.back().push_back(var.value());
+        }
+
+        Solver s;
+        build(s);
+        s.setSolutionCache(4, 1e-3, reinstall);
+        for (std::size_t k = 0; k < expected.size(); ++k) {
+            s.suggestValue(total, sizes[k][0]);
+            s.suggestValue(height, sizes[k][1]);
+            s.updateVariables();
+            for (int i = 0; i < count; ++i)
+                EXPECT_NEAR(width[i].value(), expected[k][i], 1e-6);
+        }
+        EXPECT_EQ(s.stats().cacheMisses, 3u);
+        EXPECT_EQ(s.stats().cacheHits, 3u);
+
+        // Structural changes clear the cache and see the last suggestion
+        s.addConstraint(width[0] <= 20);
+        s.updateVariables();
+        EXPECT_NEAR(width[0].value(), 20, 1e-6);
+        EXPECT_NEAR(total.value(), 400, 1e-6);
+        EXPECT_EQ(s.stats().cacheMisses, 4u);
+    }
+}
+
+// Test that the solution cache accepts values too large to quantize as integers
+TEST(SolverTest, SolutionCacheHugeValues) {
+    Variable x("x");
+    Variable y("y");
+    Solver s;
+    s.addEditVariable(x, strength::strong);
+    s.addConstraint(y == 2 * x);
+    s.setSolutionCache(4, 1e-6, false);
+    for (double value : {1e300, -1e300, 1e300}) {
+        s.suggestValue(x, value);
+        s.updateVariables();
+        EXPECT_EQ(x.value(), value);
+        EXPECT_EQ(y.value(), 2 * value);
+    }
+    EXPECT_EQ(s.stats().cacheMisses, 2u);
+    EXPECT_EQ(s.stats().cacheHits, 1u);
+}
+
+// Test that a budgeted suggestion can be resumed to the full solution
+TEST(SolverTest, BudgetedSuggestValue) {
+    const int count = 12;
+    std::vector<Variable> left(count);
+    std::vector<Variable> width(count);
+    Variable total("total");
+    auto build = [&](Solver& s) {
+        s.addEditVariable(total, strength::strong);
+        s.addConstraint(left[0] == 0);
+        for (int i = 0; i < count; ++i) {
+            s.addConstraint(width[i] >= 10);
+            s.addConstraint((width[i] == 50) | strength::create(0, 0, i + 1));
+            if (i > 0)
+                s.addConstraint(left[i] == left[i - 1] + width[i - 1] + 5);
+        }
+        s.addConstraint(left[count - 1] + width[count - 1] <= total);
+    };
+
+    Solver reference;
+    build(reference);
+    reference.suggestValue(total, 200);
+    reference.updateVariables();
+    std::vector<double> expected;
+    for (const auto& var : width)
+        expected.push_back(var.value());
+
+    Solver s;
+    build(s);
+    s.suggestValue(total, 1000);
+    s.updateVariables();
+    EXPECT_NEAR(width[0].value(), 50, 1e-6);
+
+    std::size_t pivots = s.stats().dualPivots;
+    EXPECT_FALSE(s.suggestValue(total, 200, Budget(1)));
+    EXPECT_EQ(s.stats().dualPivots, ++pivots);
+
+    // The variables keep their last solved values until completion
+    s.updateVariables();
+    EXPECT_NEAR(total.value(), 1000, 1e-6);
+
+    int frames = 1;
+    while (!s.resume(Budget(1))) {
+        EXPECT_EQ(s.stats().dualPivots, ++pivots);
+        ++frames;
+    }
+    EXPECT_GT(frames, 1);
+    s.updateVariables();
+    EXPECT_NEAR(total.value(), 200, 1e-6);
+    for (int i = 0; i < count; ++i)
+        EXPECT_NEAR(width[i].value(), expected[i], 1e-6);
+
+    // An expired deadline stops before the first pivot
+    EXPECT_FALSE(s.suggestValue(total, 1000, Budget(0, Budget::Clock::now())));
+    s.addConstraint(width[0] <= 40);
+    s.updateVariables();
+    EXPECT_NEAR(total.value(), 1000, 1e-6);
+    EXPECT_NEAR(width[0].value(), 40, 1e-6);
+    EXPECT_TRUE(s.resume());
+}
+
+// Test that the batch methods solve like the one at a time methods
+TEST(SolverTest, BatchMethods) {
+    const int count = 20;
+    std::vector<Variable> left(count);
+    std::vector<Variable> width(count);
+    Variable total("total");
+    Variable offset("offset");
+    std::vector<Constraint> constraints;
+    std::vector<Constraint> preferences;
+    constraints.push_back(left[0] == offset);
+    for (int i = 0; i < count; ++i) {
+        preferences.push_back((width[i] == 50) | strength::create(0, 0, i + 1));
+        constraints.push_back(width[i] >= 10);
+        constraints.push_back(preferences.back());
+        if (i > 0)
+            constraints.push_back(left[i] >= left[i - 1] + width[i - 1] + 5);
+    }
+    constraints.push_back(left[count - 1] + width[count - 1] <= total);
+
+    Solver reference;
+    reference.addEditVariable(total, strength::strong);
+    reference.addEditVariable(offset, strength::strong);
+    for (const auto& constraint : constraints)
+        reference.addConstraint(constraint);
+    reference.suggestValue(total, 600);
+    reference.suggestValue(offset, 20);
+    reference.updateVariables();
+    std::vector<double> expected;
+    for (const auto& var : width)
+        expected.push_back(var.value());
+
+    Solver s;
+    s.addEditVariables({{total, strength::strong}, {offset, strength::strong}});
+    s.addConstraints(constraints);
+    s.suggestValues({{total, 600}, {offset, 20}});
+    s.updateVariables();
+    for (int i = 0; i < count; ++i)
+        EXPECT_NEAR(width[i].value(), expected[i], 1e-8);
+    EXPECT_NEAR(left[0].value(), 20, 1e-8);
+
+    // Failing batches leave the solver untouched.
+    Constraint extra(left[0] >= 0);
+    EXPECT_THROW(s.addConstraints({extra, constraints[3]}), DuplicateConstraint);
+    EXPECT_THROW(s.addConstraints({extra, extra}), DuplicateConstraint);
+    EXPECT_FALSE(s.hasConstraint(extra));
+    Constraint impossible(left[1] <= -100);
+    EXPECT_THROW(s.addConstraints({extra, impossible}), UnsatisfiableConstraint);
+    EXPECT_FALSE(s.hasConstraint(extra));
+    EXPECT_THROW(s.suggestValues({{total, 100}, {width[0], 1}}), UnknownEditVariable);
+    EXPECT_THROW(s.addEditVariables({{width[0], strength::weak}, {total, strength::weak}}),
+                 DuplicateEditVariable);
+    EXPECT_FALSE(s.hasEditVariable(width[0]));
+    EXPECT_THROW(s.addEditVariables({{width[0], strength::required}}), BadRequiredStrength);
+    EXPECT_THROW(s.removeConstraints({constraints[1], extra}), UnknownConstraint);
+    EXPECT_TRUE(s.hasConstraint(constraints[1]));
+    s.updateVariables();
+    for (int i = 0; i < count; ++i)
+        EXPECT_NEAR(width[i].value(), expected[i], 1e-8);
+
+    // Removing the width preferences keeps the layout feasible.
+    s.removeConstraints(preferences);
+    s.updateVariables();
+    for (int i = 0; i < count; ++i) {
+        EXPECT_FALSE(s.hasConstraint(preferences[i]));
+        EXPECT_GE(width[i].value(), 10 - 1e-8);
+    }
+    EXPECT_LE(left[count - 1].value() + width[count - 1].value(), 600 + 1e-8);
+}
@@ -0,0 +1,63 @@
+/*-----------------------------------------------------------------------------
+| Copyright (c) 2026, Nucleic Development Team.
+|
+| Distributed under the terms of the Modified BSD License.
+|
+| The full license is in the file LICENSE, distributed with this software.
+|----------------------------------------------------------------------------*/
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <kiwi/kiwi.h>
+
+using kiwi::impl::ThreadPool;
+
+// Test that every index of a run is executed exactly once
+TEST(ThreadPoolTest, Run) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> counts(100);
+    pool.run(counts.size(), [&](std::size_t i) { ++counts[i]; });
+    for (const auto& count : counts)
+        EXPECT_EQ(count.load(), 1);
+}
+
+// Test that an exception thrown by a task is rethrown by the caller
+TEST(ThreadPoolTest, Exception) {
+    ThreadPool pool(4);
+    std::atomic<int> runs(0);
+    EXPECT_THROW(
+        pool.run(64, [&](std::size_t i) {
+            ++runs;
+            if (i % 16 == 3)
+                throw std::runtime_error("task failed");
+        }),
+        std::runtime_error);
+    EXPECT_EQ(runs.load(), 64);
+
+    // The pool is still usable after a failed run
+    runs = 0;
+    pool.run(64, [&](std::size_t) { ++runs; });
+    EXPECT_EQ(runs.load(), 64);
+}
+
+// Test that the pool is shared, capped, and usable from several threads
+TEST(ThreadPoolTest, Shared) {
+    ThreadPool& pool = ThreadPool::shared();
+    EXPECT_EQ(&pool, &ThreadPool::shared());
+    EXPECT_LE(pool.size(), std::size_t(ThreadPool::max_size));
+
+    std::atomic<int> runs(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 50; ++i)
+                pool.run(8, [&](std::size_t) { ++runs; });
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT_EQ(runs.load(), 4 * 50 * 8);
+}